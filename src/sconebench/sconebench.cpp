@@ -18,6 +18,7 @@
 #include "scone/optimization/opt_tools.h"
 #include "xo/utility/arg_parser.h"
 #include "xo/string/pattern_matcher.h"
+#include <thread>
 
 int main( int argc, const char* argv[] )
 {
@@ -37,6 +38,12 @@ int main( int argc, const char* argv[] )
 		auto results_folder = folder / "_benchmark_results" / xo::get_computer_name() + "-" + xo::get_compiler_id();
 		bool create_baseline = args.has_flag( "b" );
 		bool fast = args.has_flag( "fast" );
+		bool construction = args.has_flag( "construction" );
+		bool determinism = args.has_flag( "determinism" );
+		bool allocations = args.has_flag( "allocations" );
+		auto duration = args.get<double>( "duration", 2.0 );
+		auto max_threads = args.get<size_t>( "max_threads", std::max<size_t>( 1, std::thread::hardware_concurrency() ) );
+		auto construction_models = args.get<size_t>( "construction_models", 8 );
 
 		SCONE_ERROR_IF( !xo::directory_exists( folder ), "Folder does not exist: " + folder.str() );
 
@@ -53,16 +60,30 @@ int main( int argc, const char* argv[] )
 		xo::log::info( "Running benchmarks from ", folder );
 		xo::log::info( "Baseline: ", bopt.baseline_file );
 		auto files = xo::find_files( folder, include, exclude, true, 0 );
+		size_t failed_checks = 0;
 		for ( const auto& f : files )
 		{
 			try {
 				auto scenario_pn = scone::LoadScenario( f );
-				scone::BenchmarkScenario( scenario_pn, f, bopt );
+				if ( determinism )
+					failed_checks += !scone::CheckEvaluationDeterminism( scenario_pn, f, max_threads );
+				else if ( allocations )
+					failed_checks += !scone::CountSteadyStateAllocations( scenario_pn, f, duration ).empty();
+				else if ( construction )
+					scone::BenchmarkModelConstruction( scenario_pn, f, max_threads, construction_models );
+				else scone::BenchmarkScenario( scenario_pn, f, bopt );
 			}
 			catch ( std::exception& e ) {
 				scone::log::error( "Error benchmarking ", f.filename(), ": ", e.what() );
+				failed_checks += determinism || allocations;
 			}
 		}
+
+		// determinism and allocation checks are used in CI, report failures through the exit code
+		if ( failed_checks > 0 ) {
+			scone::log::error( failed_checks, determinism ? " determinism" : " allocation", " check(s) failed" );
+			return 1;
+		}
 	}
 	catch ( std::exception& e ) {
 		scone::log::critical( e.what() );
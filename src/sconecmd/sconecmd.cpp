@@ -10,8 +10,11 @@
 #include "scone/core/Exception.h"
 #include "scone/core/Factories.h"
 #include "scone/core/Log.h"
+#include "scone/core/profiler_config.h"
+#include "scone/core/Profiler.h"
 #include "scone/core/version.h"
 #include "scone/optimization/opt_tools.h"
+#include "scone/optimization/ProcessEvaluator.h"
 #include "scone/sconelib_config.h"
 #include "spot/optimizer_pool.h"
 #include "xo/container/prop_node_tools.h"
@@ -62,16 +65,18 @@ int main( int argc, char* argv[] )
 		TCLAP::ValueArg< String > outArg( "r", "result", "Output file for evaluation result", false, "", "Output file (*.sto)", cmd );
 		TCLAP::ValueArg< int > logArg( "l", "log", "Set the log level", false, 1, "1-7", cmd );
 		TCLAP::ValueArg< String > testArg( "", "test", "Perform test (internal use only)", false, "", "" );
+		TCLAP::ValueArg< String > workerArg( "", "worker", "Run as evaluation worker process (internal use only)", false, "", "config.scone" );
 		TCLAP::SwitchArg statusOutput( "s", "status", "Output full status updates", cmd, false );
 		TCLAP::SwitchArg quietOutput( "q", "quiet", "Do not output simulation progress", cmd, false );
+		TCLAP::ValueArg< String > traceArg( "", "trace", "Profile all threads and write a Chrome trace file", false, "", "trace.json", cmd );
 		TCLAP::UnlabeledMultiArg< string > propArg( "property", "Override specific scenario property, using <key>=<value>", false, "<key>=<value>", cmd, true );
 #if SCONE_HYFYDY_ENABLED
 		std::vector<string> hyfydyOptions{ "id", "key" };
 		TCLAP::ValuesConstraint<string> allowedVals( hyfydyOptions );
 		TCLAP::ValueArg< String > licenseArg( "", "hyfydy", "Hyfydy license key management", true, "", &allowedVals );
-		auto xor_args = std::vector<TCLAP::Arg*>{ &optArg, &parArg , &benchArg, &licenseArg, &testArg };
+		auto xor_args = std::vector<TCLAP::Arg*>{ &optArg, &parArg , &benchArg, &licenseArg, &testArg, &workerArg };
 #else
-		auto xor_args = std::vector<TCLAP::Arg*>{ &optArg, &parArg , &benchArg };
+		auto xor_args = std::vector<TCLAP::Arg*>{ &optArg, &parArg , &benchArg, &workerArg };
 #endif
 		cmd.xorAdd( xor_args );
 		cmd.parse( argc, argv );
@@ -82,6 +87,10 @@ int main( int argc, char* argv[] )
 			if ( logArg.isSet() )
 				console_sink.set_log_level( xo::log::level( logArg.getValue() ) );
 
+			// profile all threads
+			if ( traceArg.isSet() )
+				scone::SetProfilerEnabled( true );
+
 			// do optimization or evaluation
 			if ( optArg.isSet() )
 			{
@@ -134,6 +143,10 @@ int main( int argc, char* argv[] )
 			{
 				scone::perform_test( testArg.getValue() );
 			}
+			else if ( workerArg.isSet() )
+			{
+				return scone::RunEvaluationWorker( workerArg.getValue() );
+			}
 #if SCONE_HYFYDY_ENABLED
 			else if ( licenseArg.isSet() ) {
 				if ( licenseArg.getValue() == hyfydyOptions[0] )
@@ -142,6 +155,15 @@ int main( int argc, char* argv[] )
 					sconehfd::AddLicenseInteractive();
 			}
 #endif
+
+			if ( traceArg.isSet() )
+			{
+				scone::SetProfilerEnabled( false );
+				auto& prof = scone::Profiler::GetGlobalInstance();
+				prof.WriteChromeTrace( traceArg.getValue() );
+				scone::log::info( "Profile report:\n", prof.GetReport() );
+				scone::log::info( "Trace written to ", traceArg.getValue() );
+			}
 		}
 		catch ( std::exception& e )
 		{
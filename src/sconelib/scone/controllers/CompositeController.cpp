@@ -107,6 +107,14 @@ namespace scone
 		return pn;
 	}
 
+	SimulationStage CompositeController::GetRequiredStage() const
+	{
+		auto stage = Controller::GetRequiredStage();
+		for ( auto& c : controllers_ )
+			stage = std::max( stage, c->GetRequiredStage() );
+		return stage;
+	}
+
 	Controller* CompositeController::InsertChildController( ControllerUP child, index_t pos )
 	{
 		auto it = controllers_.begin() + std::min( pos, controllers_.size() );
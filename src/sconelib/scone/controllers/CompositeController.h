@@ -48,6 +48,7 @@ namespace scone
 		std::vector<String> child_names;
 
 		virtual PropNode GetInfo() const override;
+		virtual SimulationStage GetRequiredStage() const override;
 
 		const std::vector< ControllerUP >& GetChildren() const { return controllers_; }
 		std::vector< ControllerUP >& GetChildren() { return controllers_; }
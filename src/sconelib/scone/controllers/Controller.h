@@ -12,15 +12,17 @@
 #include "scone/core/HasSignature.h"
 #include "scone/core/HasData.h"
 #include "scone/model/State.h"
+#include "scone/model/SimulationStage.h"
 #include "scone/optimization/Params.h"
 #include "xo/filesystem/path.h"
 #include "scone/core/HasName.h"
 #include "scone/core/UpdateResult.h"
+#include "scone/core/ModelArena.h"
 
 namespace scone
 {
 	/// Base class for SCONE Controllers. See derived classes for specific functionality.
-	class SCONE_API Controller : public HasSignature, public HasData, public HasName
+	class SCONE_API Controller : public HasSignature, public HasData, public HasName, public ArenaAllocated
 	{
 	public:
 		Controller( const PropNode& props, Params& par, Model& model, const Location& target_area );
@@ -57,6 +59,10 @@ namespace scone
 		virtual const String& GetName() const override { return name_; }
 		virtual PropNode GetInfo() const { return PropNode(); }
 
+		// Highest stage of the model state that this controller accesses during updates
+		// Data from higher stages is still available, but is computed on request
+		virtual SimulationStage GetRequiredStage() const { return SimulationStage::Dynamics; }
+
 		// Set control parameter value, returns number of parameters set
 		virtual int TrySetControlParameter( const String& name, Real value ) { return 0; }
 		virtual xo::optional<Real> TryGetControlParameter( const String& name ) { return {}; }
@@ -70,6 +70,7 @@ namespace scone
 			m_Functions.push_back( CreateFunction( fp, par ) );
 			ai.function_idx = m_Functions.size() - 1;
 		}
+		m_FunctionResults.resize( m_Functions.size() );
 	}
 
 	bool FeedForwardController::ComputeControls( Model& model, double time )
@@ -77,16 +78,15 @@ namespace scone
 		SCONE_PROFILE_FUNCTION( model.GetProfiler() );
 
 		// evaluate functions
-		std::vector< double > funcresults( m_Functions.size() );
 		for ( size_t idx = 0; idx < m_Functions.size(); ++idx )
-			funcresults[idx] = m_Functions[idx]->GetValue( time );
+			m_FunctionResults[idx] = m_Functions[idx]->GetValue( time );
 
 		// apply results to all actuators
 		auto& actuators = model.GetActuators();
 		for ( ActInfo& ai : m_ActInfos )
 		{
 			// apply results directly to control value
-			actuators[ai.actuator_idx]->AddInput( funcresults[ai.function_idx] );
+			actuators[ai.actuator_idx]->AddInput( m_FunctionResults[ai.function_idx] );
 		}
 
 		return false;
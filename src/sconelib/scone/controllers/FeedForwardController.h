@@ -56,5 +56,6 @@ namespace scone
 
 		std::vector< FunctionUP > m_Functions;
 		std::vector< ActInfo > m_ActInfos;
+		std::vector< double > m_FunctionResults; // buffer for ComputeControls()
 	};
 }
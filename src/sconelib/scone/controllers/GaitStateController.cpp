@@ -167,8 +167,8 @@ namespace scone
 		{
 			LegState& ls = m_LegStates[idx];
 			ls.leg_load = ls.load_sensor.GetValue( leg_load_sensor_delay );
-			ls.allow_stance_transition = ls.load_sensor.GetValue( leg_load_sensor_delay ) > ls.stance_load_threshold;
-			ls.allow_swing_transition = ls.load_sensor.GetValue( leg_load_sensor_delay ) <= ls.swing_load_threshold;
+			ls.allow_stance_transition = ls.leg_load > ls.stance_load_threshold;
+			ls.allow_swing_transition = ls.leg_load <= ls.swing_load_threshold;
 			auto reference_pos = use_model_com_reference_pos ? model.GetComPos() : ls.leg.GetBaseBody().GetComPos();
 			if ( omnidirectional && model.HasRootBody() ) {
 				auto root_ori = model.GetRootBody().GetOrientation();
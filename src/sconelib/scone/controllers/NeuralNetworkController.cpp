@@ -392,6 +392,14 @@ namespace scone::NN
 					pn.get<double>( "delay" ), 0 );
 			break;
 		}
+		case "BodyRayDistanceSensor"_hash:
+		{
+			const auto& body = *FindByName( model.GetBodies(), pn.get<String>( "body" ) );
+			auto& sensor = model.AcquireSensor<BodyRayDistanceSensor>(
+				body, pn.get<Vec3>( "offset", Vec3::zero() ), pn.get<Vec3>( "dir" ), pn.get<Real>( "max_distance", 1.0 ) );
+			AddSensor( model, sensor, pn.get<double>( "delay" ), 0 );
+			break;
+		}
 		case "BodyAngularVelocitySensor"_hash:
 		{
 			const auto& body = *FindByName( model.GetBodies(), pn.get<String>( "body" ) );
@@ -12,6 +12,7 @@
 #include "scone/core/PropNode.h"
 #include "scone/optimization/Params.h"
 #include "scone/core/HasData.h"
+#include "scone/core/ModelArena.h"
 #include "activation_functions.h"
 #include "scone/model/Side.h"
 
@@ -21,7 +22,7 @@ namespace scone
 	struct SensorNeuron;
 	using activation_t = double;
 
-	struct Neuron
+	struct Neuron : public ArenaAllocated
 	{
 		Neuron( const PropNode& pn, const String& name, index_t idx, Side s, const String& act_func );
 		virtual ~Neuron() {}
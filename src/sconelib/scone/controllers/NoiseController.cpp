@@ -18,16 +18,42 @@ namespace scone
 	NoiseController::NoiseController( const PropNode& props, Params& par, Model& model, const Location& loc ) :
 		Controller( props, par, model, loc ),
 		random_seed( GetRandomSeed( props, par ) ),
-		rng_( random_seed )
+		rng_( random_seed ),
+		counter_rng_( random_seed ),
+		update_count_( 0 )
 	{
 		INIT_PROP( props, base_noise, 0 );
 		INIT_PROP( props, proportional_noise, 0 );
+		INIT_PROP( props, use_counter_rng, false );
+		if ( use_counter_rng )
+			noise_.resize( model.GetActuators().size() );
+	}
+
+	void NoiseController::Reset( Model& model )
+	{
+		// the legacy rng_ continues its sequence after Reset(), as it did before use_counter_rng was added
+		update_count_ = 0;
 	}
 
 	bool NoiseController::ComputeControls( Model& model, double timestamp )
 	{
 		SCONE_PROFILE_FUNCTION( model.GetProfiler() );
 
+		if ( use_counter_rng )
+		{
+			// generate noise for all actuators at once, keyed by control update
+			auto& actuators = model.GetActuators();
+			SCONE_ASSERT( actuators.size() == noise_.size() );
+			counter_rng_.fill_normal( update_count_++, noise_ );
+			for ( index_t i = 0; i < actuators.size(); ++i )
+			{
+				auto noise_std = base_noise + proportional_noise * actuators[i]->GetInput();
+				if ( noise_std > 0.0 )
+					actuators[i]->AddInput( noise_std * noise_[i] );
+			}
+			return false;
+		}
+
 		for ( auto& a : model.GetActuators() )
 		{
 			auto noise_std = base_noise + proportional_noise * a->GetInput();
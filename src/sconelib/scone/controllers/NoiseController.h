@@ -8,6 +8,7 @@
 
 #pragma once
 #include "Controller.h"
+#include "scone/core/CounterRng.h"
 #include "xo/numerical/random.h"
 
 namespace scone
@@ -30,10 +31,19 @@ namespace scone
 		/// Random seed for noise sampling; default = 123.
 		unsigned int random_seed;
 
+		/// Use counter-based noise that only depends on ( random_seed, actuator, control update ), which makes
+		/// results independent of evaluation order and reproducible after Reset(); default = 0.
+		bool use_counter_rng;
+
+		virtual void Reset( Model& model ) override;
+
 	protected:
 		virtual bool ComputeControls( Model& model, double timestamp ) override;
 		virtual String GetClassSignature() const override;
 
 		xo::random_number_generator_default rng_;
+		CounterRng counter_rng_;
+		std::vector<double> noise_;
+		std::uint64_t update_count_; // number of control updates since Reset(), used as counter_rng_ stream
 	};
 }
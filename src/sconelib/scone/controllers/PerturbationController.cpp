@@ -19,10 +19,12 @@ namespace scone
 		body( *FindByName( model.GetBodies(), props.get< String >( "body" ) ) ),
 		random_seed( props.get( "random_seed", 5489 ) ),
 		rng_( random_seed ),
+		counter_rng_( random_seed ),
 		active_( false ),
 		current_force(),
 		current_moment()
 	{
+		INIT_PROP( props, use_counter_rng, false );
 		INIT_PROP( props, force, Vec3::zero() );
 		INIT_PROP( props, moment, Vec3::zero() );
 		INIT_PROP( props, position_offset, Vec3::zero() );
@@ -46,8 +48,15 @@ namespace scone
 	void PerturbationController::AddPerturbation()
 	{
 		Perturbation p;
-		p.start = perturbations.empty() ? start_time : perturbations.back().start + rng_.uniform( interval );
-		p.stop = p.start + rng_.uniform( duration );
+		if ( use_counter_rng ) {
+			const auto idx = perturbations.size();
+			p.start = perturbations.empty() ? start_time : perturbations.back().start + counter_rng_.uniform( idx, 0, interval );
+			p.stop = p.start + counter_rng_.uniform( idx, 1, duration );
+		}
+		else {
+			p.start = perturbations.empty() ? start_time : perturbations.back().start + rng_.uniform( interval );
+			p.stop = p.start + rng_.uniform( duration );
+		}
 		p.force = force;
 		p.moment = moment;
 		perturbations.emplace_back( p );
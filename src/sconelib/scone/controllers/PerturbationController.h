@@ -13,6 +13,7 @@
 #include "scone/core/PropNode.h"
 #include "scone/optimization/Params.h"
 #include "scone/core/Vec3.h"
+#include "scone/core/CounterRng.h"
 #include <random>
 #include "xo/numerical/bounds.h"
 #include "xo/numerical/random.h"
@@ -41,6 +42,9 @@ namespace scone
 		/// Random seed used for the perturbation sequence; default = 5489.
 		unsigned int random_seed;
 
+		/// Draw perturbation intervals and durations from a counter-based generator keyed by ( random_seed, perturbation index ); default = 0.
+		bool use_counter_rng;
+
 		/// Fixed time [s] between two perturbations; default 2.
 		xo::bounds< TimeInSeconds > interval;
 
@@ -69,6 +73,7 @@ namespace scone
 		std::vector< Perturbation > perturbations;
 
 		xo::random_number_generator_default rng_;
+		CounterRng counter_rng_;
 
 		bool active_;
 		Vec3 current_force;
@@ -12,6 +12,7 @@
 #include "scone/core/math.h"
 #include "scone/core/HasData.h"
 #include "scone/core/PropNode.h"
+#include "scone/core/ModelArena.h"
 #include "scone/model/Location.h"
 #include "scone/optimization/Params.h"
 #include "scone/core/ValuePtrMap.h"
@@ -19,7 +20,7 @@
 namespace scone
 {
 	/// Base class for reflexes, requires use of ReflexController. See inherited Controllers for details.
-	class Reflex : public HasData
+	class Reflex : public HasData, public ArenaAllocated
 	{
 	public:
 		Reflex( const PropNode& props, Params& par, Model& model, ReflexController& rc, const Location& loc );
@@ -0,0 +1,141 @@
+/*
+** AllocationTracker.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#include "AllocationTracker.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace scone
+{
+	namespace
+	{
+		// counters are zero-initialized before any dynamic initialization, so they can be used by operator new at any time
+		constexpr size_t max_allocation_sites = 1024; // the last site counts allocations outside (or beyond) registered scopes
+		std::array< std::atomic< size_t >, max_allocation_sites > g_AllocationSites;
+		std::atomic< size_t > g_ExemptAllocationCount;
+		thread_local size_t g_ThreadAllocationCount = 0;
+		thread_local int g_PauseDepth = 0;
+		thread_local bool g_Exempt = false;
+		thread_local ProfileScopeId g_ExemptScope = Profiler::NoScope;
+
+#if SCONE_ALLOCATION_TRACKING_ENABLED
+		void CountAllocation()
+		{
+			if ( g_PauseDepth > 0 )
+				return;
+			++g_ThreadAllocationCount;
+			const auto scope = Profiler::GetCurrentScope();
+			if ( g_Exempt && scope == g_ExemptScope )
+				g_ExemptAllocationCount.fetch_add( 1, std::memory_order_relaxed );
+			else g_AllocationSites[std::min< size_t >( scope, max_allocation_sites - 1 )].fetch_add( 1, std::memory_order_relaxed );
+		}
+#endif
+	}
+
+	bool IsAllocationTrackingAvailable()
+	{
+		return SCONE_ALLOCATION_TRACKING_ENABLED;
+	}
+
+	size_t GetThreadAllocationCount()
+	{
+		return g_ThreadAllocationCount;
+	}
+
+	std::vector< std::pair< String, size_t > > GetAllocationSites()
+	{
+		AllocationTrackingPause pause;
+		std::vector< std::pair< String, size_t > > sites;
+		for ( size_t i = 0; i < max_allocation_sites; ++i )
+		{
+			if ( auto n = g_AllocationSites[i].load( std::memory_order_relaxed ); n > 0 )
+			{
+				const bool unscoped = i == max_allocation_sites - 1;
+				sites.emplace_back( unscoped ? "(unscoped)" : Profiler::GetGlobalInstance().GetScopeName( ProfileScopeId( i ) ), n );
+			}
+		}
+		std::stable_sort( sites.begin(), sites.end(), []( const auto& a, const auto& b ) { return a.second > b.second; } );
+		return sites;
+	}
+
+	void ResetAllocationSites()
+	{
+		for ( auto& n : g_AllocationSites )
+			n.store( 0, std::memory_order_relaxed );
+		g_ExemptAllocationCount.store( 0, std::memory_order_relaxed );
+	}
+
+	size_t GetExemptAllocationCount()
+	{
+		return g_ExemptAllocationCount.load( std::memory_order_relaxed );
+	}
+
+	AllocationExemption::AllocationExemption() :
+		m_PrevExempt( std::exchange( g_Exempt, true ) ),
+		m_PrevScope( std::exchange( g_ExemptScope, Profiler::GetCurrentScope() ) )
+	{}
+
+	AllocationExemption::~AllocationExemption()
+	{
+		g_Exempt = m_PrevExempt;
+		g_ExemptScope = m_PrevScope;
+	}
+
+	AllocationTrackingPause::AllocationTrackingPause()
+	{
+		++g_PauseDepth;
+	}
+
+	AllocationTrackingPause::~AllocationTrackingPause()
+	{
+		--g_PauseDepth;
+	}
+}
+
+#if SCONE_ALLOCATION_TRACKING_ENABLED
+
+// Replacements of the global allocation functions, see AllocationTracker.h.
+// Over-aligned allocations (std::align_val_t overloads) are not counted.
+void* operator new( std::size_t size )
+{
+	scone::CountAllocation();
+	if ( void* p = std::malloc( size > 0 ? size : 1 ) )
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[]( std::size_t size )
+{
+	return operator new( size );
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+	scone::CountAllocation();
+	return std::malloc( size > 0 ? size : 1 );
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& tag ) noexcept
+{
+	return operator new( size, tag );
+}
+
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete[]( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, std::size_t ) noexcept { std::free( p ); }
+void operator delete[]( void* p, std::size_t ) noexcept { std::free( p ); }
+void operator delete( void* p, const std::nothrow_t& ) noexcept { std::free( p ); }
+void operator delete[]( void* p, const std::nothrow_t& ) noexcept { std::free( p ); }
+
+#endif
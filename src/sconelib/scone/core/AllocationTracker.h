@@ -0,0 +1,73 @@
+/*
+** AllocationTracker.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#pragma once
+
+#include "platform.h"
+#include "types.h"
+#include "Profiler.h"
+#include <utility>
+#include <vector>
+
+namespace scone
+{
+	/// Heap allocation counting, used to find allocations in the simulation loop.
+	/// Allocations are only counted when SCONE is built with SCONE_ALLOCATION_TRACKING, which replaces
+	/// the global operator new and delete; otherwise all counts remain zero.
+	SCONE_API bool IsAllocationTrackingAvailable();
+
+	/// Number of heap allocations made by the current thread.
+	SCONE_API size_t GetThreadAllocationCount();
+
+	/// Number of allocations per profiler scope since the last ResetAllocationSites(), highest count first.
+	/// Allocations are attributed to the innermost scope recorded by the global Profiler,
+	/// which must be active; other allocations are listed as "(unscoped)".
+	/// Exempt allocations are not included.
+	SCONE_API std::vector< std::pair< String, size_t > > GetAllocationSites();
+	SCONE_API void ResetAllocationSites();
+
+	/// Number of exempt allocations since the last ResetAllocationSites(), see AllocationExemption.
+	SCONE_API size_t GetExemptAllocationCount();
+
+	/// Number of allocations made by the current thread during the lifetime of this object.
+	class ScopedAllocationCount
+	{
+	public:
+		ScopedAllocationCount() : m_Start( GetThreadAllocationCount() ) {}
+		size_t operator()() const { return GetThreadAllocationCount() - m_Start; }
+
+	private:
+		size_t m_Start;
+	};
+
+	/// Allocations made by the current thread in the current profiler scope are exempt during the lifetime of this object.
+	/// Used at call sites of external libraries that allocate internally, such as the OpenSim integrator.
+	/// Code called back from the library in a nested profiler scope is not exempt, which requires an active global Profiler.
+	class SCONE_API AllocationExemption
+	{
+	public:
+		AllocationExemption();
+		~AllocationExemption();
+		AllocationExemption( const AllocationExemption& ) = delete;
+		AllocationExemption& operator=( const AllocationExemption& ) = delete;
+
+	private:
+		bool m_PrevExempt;
+		ProfileScopeId m_PrevScope;
+	};
+
+	/// Allocations made by the current thread are not counted during the lifetime of this object.
+	class SCONE_API AllocationTrackingPause
+	{
+	public:
+		AllocationTrackingPause();
+		~AllocationTrackingPause();
+		AllocationTrackingPause( const AllocationTrackingPause& ) = delete;
+		AllocationTrackingPause& operator=( const AllocationTrackingPause& ) = delete;
+	};
+}
@@ -5,6 +5,9 @@
 #include "scone/optimization/Optimizer.h"
 #include "scone/optimization/SimulationObjective.h"
 #include "scone/core/profiler_config.h"
+#include "scone/core/ParallelReduce.h"
+#include "scone/core/AllocationTracker.h"
+#include "scone/core/Profiler.h"
 
 #include "xo/time/timer.h"
 #include "xo/container/prop_node_tools.h"
@@ -15,6 +18,10 @@
 #include "xo/thread/thread_priority.h"
 #include "Log.h"
 
+#include <thread>
+#include <atomic>
+#include <cstring>
+
 namespace scone
 {
 	void BenchmarkScenario( const PropNode& scenario_pn, const path& file, const BenchmarkOptions& bo )
@@ -156,4 +163,142 @@ namespace scone
 			xo::append_string( fixed_results_file, results_string + "\n" );
 		}
 	}
+
+	bool CheckEvaluationDeterminism( const PropNode& scenario_pn, const path& file, size_t max_threads )
+	{
+		log::info( "---\nDETERMINISM CHECK: ", file.parent_path().stem() / file.filename() );
+
+		auto opt = CreateOptimizer( scenario_pn, file.parent_path() );
+		auto& obj = opt->GetObjective();
+		auto par = SearchPoint( obj.info() );
+		if ( file.extension_no_dot() == "par" )
+			par.import_values( file );
+
+		auto evaluate = [&]( size_t threads ) {
+			SetEvaluationThreadCount( threads );
+			try {
+				auto r = obj.evaluate( par, xo::stop_token() );
+				SetEvaluationThreadCount( no_size );
+				SCONE_ERROR_IF( !r, "Evaluation failed: " + r.error().message() );
+				return r.value();
+			}
+			catch ( ... ) {
+				SetEvaluationThreadCount( no_size );
+				throw;
+			}
+		};
+
+		const auto single = evaluate( 1 );
+		const auto multi = evaluate( max_threads );
+		const bool identical = std::memcmp( &single, &multi, sizeof( single ) ) == 0;
+		if ( identical )
+			log::info( xo::stringf( "threads=1 and threads=%zu give identical fitness %.17g", max_threads, single ) );
+		else log::error( xo::stringf( "Fitness differs: threads=1 gives %.17g, threads=%zu gives %.17g", single, max_threads, multi ) );
+		return identical;
+	}
+
+	std::vector< std::pair< String, size_t > > CountSteadyStateAllocations( const PropNode& scenario_pn, const path& file, TimeInSeconds duration )
+	{
+		log::info( "---\nALLOCATION CHECK: ", file.parent_path().stem() / file.filename() );
+		SCONE_ERROR_IF( !IsAllocationTrackingAvailable(), "Allocation check requires a build with SCONE_ALLOCATION_TRACKING" );
+
+		auto opt = CreateOptimizer( scenario_pn, file.parent_path() );
+		auto mo = dynamic_cast<ModelObjective*>( &opt->GetObjective() );
+		SCONE_ERROR_IF( !mo, "Allocation check requires a ModelObjective" );
+		auto par = SearchPoint( mo->info() );
+		if ( file.extension_no_dot() == "par" )
+			par.import_values( file );
+		auto model = mo->CreateModelFromParams( par );
+		const auto step_size = model->fixed_control_step_size;
+
+		// allocations are attributed to profiler scopes, which requires an active profiler
+		auto& prof = Profiler::GetGlobalInstance();
+		const bool profiler_was_active = prof.IsActive();
+		prof.Activate();
+
+		// the first simulation fills all buffers, the first step after Reset() re-initializes the integrator
+		model->SetSimulationEndTime( duration );
+		model->AdvanceSimulationTo( duration );
+		model->Reset();
+		model->SetSimulationEndTime( duration );
+		model->AdvanceSimulationTo( step_size );
+		ResetAllocationSites();
+
+		size_t steps = 0, allocating_steps = 0, allocations = 0;
+		for ( TimeInSeconds t = 2 * step_size; !model->HasSimulationEnded(); t += step_size )
+		{
+			const ScopedAllocationCount count;
+			model->AdvanceSimulationTo( t );
+			++steps;
+			allocating_steps += count() > 0;
+			allocations += count();
+		}
+		auto sites = GetAllocationSites();
+
+		if ( !profiler_was_active ) {
+			prof.Suspend();
+			prof.Reset();
+		}
+
+		log::info( xo::stringf( "%zu allocations in %zu of %zu steps, %zu exempt", allocations, allocating_steps, steps, GetExemptAllocationCount() ) );
+		for ( const auto& [name, count] : sites )
+			log::info( xo::stringf( "%8zu ", count ), name );
+		return sites;
+	}
+
+	void BenchmarkModelConstruction( const PropNode& scenario_pn, const path& file, size_t max_threads, size_t models_per_thread )
+	{
+		log::info( "---\nCONSTRUCTION BENCHMARK: ", file.parent_path().stem() / file.filename() );
+
+		auto opt = CreateOptimizer( scenario_pn, file.parent_path() );
+		auto mo = dynamic_cast<ModelObjective*>( &opt->GetObjective() );
+		SCONE_ERROR_IF( !mo, "Construction benchmark requires a ModelObjective" );
+		auto par = SearchPoint( mo->info() );
+		if ( file.extension_no_dot() == "par" )
+			par.import_values( file );
+
+		// models are created and destroyed concurrently, with and without use_model_arena, to measure heap contention
+		auto measure_rate = [&]( size_t threads, bool use_model_arena ) {
+			mo->use_model_arena = use_model_arena;
+			std::atomic<size_t> errors = 0;
+			xo::timer t;
+			std::vector<std::thread> workers;
+			workers.reserve( threads );
+			for ( size_t thread_idx = 0; thread_idx < threads; ++thread_idx )
+			{
+				workers.emplace_back( [&]() {
+					try {
+						for ( size_t i = 0; i < models_per_thread; ++i ) {
+							SearchPoint thread_par( par );
+							auto model = mo->CreateModelFromParams( thread_par );
+						}
+					}
+					catch ( std::exception& e ) {
+						log::error( "Error creating model: ", e.what() );
+						++errors;
+					}
+				} );
+			}
+			for ( auto& w : workers )
+				w.join();
+			auto duration = t().secondsd();
+
+			SCONE_ERROR_IF( errors > 0, "Errors occurred during model construction" );
+			return threads * models_per_thread / duration;
+		};
+
+		double single_thread_rate = 0.0, single_thread_arena_rate = 0.0;
+		for ( size_t threads = 1; threads <= max_threads; threads = threads < max_threads ? std::min( 2 * threads, max_threads ) : threads + 1 )
+		{
+			auto rate = measure_rate( threads, false );
+			auto arena_rate = measure_rate( threads, true );
+			if ( threads == 1 ) {
+				single_thread_rate = rate;
+				single_thread_arena_rate = arena_rate;
+			}
+			log::info( xo::stringf( "threads=%-4zu\t%8.2f models/s\t%6.2fx speedup\t%5.1f%% efficiency\tarena: %8.2f models/s\t%6.2fx speedup\t%5.1f%% efficiency",
+				threads, rate, rate / single_thread_rate, 100 * rate / ( threads * single_thread_rate ),
+				arena_rate, arena_rate / single_thread_arena_rate, 100 * arena_rate / ( threads * single_thread_arena_rate ) ) );
+		}
+	}
 }
@@ -5,6 +5,8 @@
 #include "PropNode.h"
 #include "xo/filesystem/path.h"
 #include "types.h"
+#include <utility>
+#include <vector>
 
 namespace scone
 {
@@ -19,6 +21,21 @@ namespace scone
 	SCONE_API void BenchmarkScenario(
 		const PropNode& scenario_pn, const path& file, const BenchmarkOptions& opt );
 
+	/// Measure model construction throughput for 1, 2, 4, ... max_threads concurrent threads, with and without use_model_arena.
+	SCONE_API void BenchmarkModelConstruction(
+		const PropNode& scenario_pn, const path& file, size_t max_threads, size_t models_per_thread );
+
+	/// Evaluate a scenario using one and using max_threads evaluation threads.
+	/// Returns true if both evaluations give the exact same fitness.
+	SCONE_API bool CheckEvaluationDeterminism( const PropNode& scenario_pn, const path& file, size_t max_threads );
+
+	/// Simulate a scenario twice and count the heap allocations per step of the second simulation,
+	/// after buffers and caches have been filled by the first. Requires SCONE_ALLOCATION_TRACKING.
+	/// Returns the number of allocations per profiler scope, highest count first,
+	/// excluding the exempt allocations of external simulators (see AllocationExemption).
+	SCONE_API std::vector< std::pair< String, size_t > > CountSteadyStateAllocations(
+		const PropNode& scenario_pn, const path& file, TimeInSeconds duration );
+
 	struct SCONE_API Benchmark {
 		String name_;
 		xo::time sim_duration_;
@@ -0,0 +1,131 @@
+/*
+** CounterRng.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "types.h"
+#include "xo/numerical/bounds.h"
+#include "xo/numerical/constants.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace scone
+{
+	/// Counter-based random number generator (Philox4x32-10).
+	/// Each random value is a pure function of ( seed, stream, index ), which means values
+	/// do not depend on evaluation order and can be generated in bulk or in parallel.
+	class CounterRng
+	{
+	public:
+		using block_type = std::array<std::uint32_t, 4>;
+
+		CounterRng( std::uint64_t seed = 0 ) :
+			key_{ std::uint32_t( seed ), std::uint32_t( seed >> 32 ) }
+		{}
+
+		// generate four random 32-bit words for ( stream, index )
+		block_type block( std::uint64_t stream, std::uint64_t index ) const {
+			block_type ctr{ std::uint32_t( index ), std::uint32_t( index >> 32 ), std::uint32_t( stream ), std::uint32_t( stream >> 32 ) };
+			auto key = key_;
+			for ( int r = 0; r < 10; ++r ) {
+				ctr = round( ctr, key );
+				key[0] += 0x9E3779B9;
+				key[1] += 0xBB67AE85;
+			}
+			return ctr;
+		}
+
+		// uniform value in [0, 1) for ( stream, index )
+		double uniform( std::uint64_t stream, std::uint64_t index ) const {
+			auto b = block( stream, index );
+			return to_unit_open( b[0], b[1] ) - 0x1.0p-53;
+		}
+
+		// uniform value within bounds for ( stream, index )
+		template< typename T > T uniform( std::uint64_t stream, std::uint64_t index, const xo::bounds<T>& b ) const {
+			return b.lower + T( uniform( stream, index ) * ( b.upper - b.lower ) );
+		}
+
+		// standard normal value for ( stream, index )
+		double normal( std::uint64_t stream, std::uint64_t index ) const {
+			auto b = block( stream, index >> 1 );
+			auto [z0, z1] = box_muller( b );
+			return ( index & 1 ) ? z1 : z0;
+		}
+
+		// fill values with standard normal samples for ( stream, 0 .. n-1 ); equivalent to calling normal( stream, i ) for each i
+		void fill_normal( std::uint64_t stream, double* values, size_t n ) const {
+			const size_t block_count = ( n + 1 ) / 2;
+			size_t b = 0;
+			for ( ; b + lanes <= block_count; b += lanes )
+			{
+				// the rounds of multiple counters are computed in lock-step, which allows the compiler to vectorize them
+				std::uint32_t c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+				for ( size_t l = 0; l < lanes; ++l ) {
+					c0[l] = std::uint32_t( b + l );
+					c1[l] = std::uint32_t( std::uint64_t( b + l ) >> 32 );
+					c2[l] = std::uint32_t( stream );
+					c3[l] = std::uint32_t( stream >> 32 );
+				}
+				auto key = key_;
+				for ( int r = 0; r < 10; ++r ) {
+					for ( size_t l = 0; l < lanes; ++l ) {
+						const std::uint64_t p0 = std::uint64_t( 0xD2511F53 ) * c0[l];
+						const std::uint64_t p1 = std::uint64_t( 0xCD9E8D57 ) * c2[l];
+						c0[l] = std::uint32_t( p1 >> 32 ) ^ c1[l] ^ key[0];
+						c1[l] = std::uint32_t( p1 );
+						c2[l] = std::uint32_t( p0 >> 32 ) ^ c3[l] ^ key[1];
+						c3[l] = std::uint32_t( p0 );
+					}
+					key[0] += 0x9E3779B9;
+					key[1] += 0xBB67AE85;
+				}
+				for ( size_t l = 0; l < lanes; ++l ) {
+					auto [z0, z1] = box_muller( { c0[l], c1[l], c2[l], c3[l] } );
+					const auto i = 2 * ( b + l );
+					values[i] = z0;
+					if ( i + 1 < n )
+						values[i + 1] = z1;
+				}
+			}
+			for ( ; b < block_count; ++b ) {
+				auto [z0, z1] = box_muller( block( stream, b ) );
+				values[2 * b] = z0;
+				if ( 2 * b + 1 < n )
+					values[2 * b + 1] = z1;
+			}
+		}
+		void fill_normal( std::uint64_t stream, std::vector<double>& values ) const { fill_normal( stream, values.data(), values.size() ); }
+
+	private:
+		static constexpr size_t lanes = 4; // number of blocks computed together in fill_normal()
+
+		static block_type round( const block_type& ctr, const std::array<std::uint32_t, 2>& key ) {
+			const std::uint64_t p0 = std::uint64_t( 0xD2511F53 ) * ctr[0];
+			const std::uint64_t p1 = std::uint64_t( 0xCD9E8D57 ) * ctr[2];
+			return { std::uint32_t( p1 >> 32 ) ^ ctr[1] ^ key[0], std::uint32_t( p1 ), std::uint32_t( p0 >> 32 ) ^ ctr[3] ^ key[1], std::uint32_t( p0 ) };
+		}
+
+		// uniform value in (0, 1] with 53 bits of precision
+		static double to_unit_open( std::uint32_t lo, std::uint32_t hi ) {
+			const std::uint64_t v = ( std::uint64_t( hi ) << 32 | lo ) >> 11;
+			return ( v + 1 ) * 0x1.0p-53;
+		}
+
+		// two independent standard normal samples from one block
+		static std::pair<double, double> box_muller( const block_type& b ) {
+			const double r = std::sqrt( -2.0 * std::log( to_unit_open( b[0], b[1] ) ) );
+			const double a = 2.0 * xo::constantsd::pi() * to_unit_open( b[2], b[3] );
+			return { r * std::cos( a ), r * std::sin( a ) };
+		}
+
+		std::array<std::uint32_t, 2> key_;
+	};
+}
@@ -1,70 +1,187 @@
 #include "GaitCycle.h"
 #include "Log.h"
+#include <cmath>
 
 namespace scone
 {
-	index_t FindNextTouch( const Storage<>& sto, index_t idx, const index_t channel_idx, const Real threshold ) {
-		while ( idx != no_index && idx < sto.GetFrameCount() && sto.GetFrame( idx )[channel_idx] <= threshold ) idx++;
-		return idx < sto.GetFrameCount() ? idx: no_index;
-	}
+	GaitCycleExtractor::GaitCycleExtractor( const std::vector<String>& labels, const GaitCycleExtractionSettings& opt,
+		const std::vector<String>& channels, size_t samples ) :
+		opt_( opt ),
+		samples_( samples ),
+		row_size_( 1 )
+	{
+		auto find_label = [&]( const String& l ) {
+			auto it = std::find( labels.begin(), labels.end(), l );
+			return it != labels.end() ? index_t( it - labels.begin() ) : no_index;
+		};
 
-	index_t FindNextFlight( const Storage<>& sto, index_t idx, const index_t channel_idx, const Real threshold ) {
-		while ( idx != no_index && idx < sto.GetFrameCount() && sto.GetFrame( idx )[channel_idx] > threshold ) idx++;
-		return idx < sto.GetFrameCount() ? idx: no_index;
-	}
+		for ( const auto& c : channels ) {
+			auto idx = find_label( c );
+			SCONE_ERROR_IF( idx == no_index, "Could not find channel " + c );
+			channel_indices_.push_back( idx );
+			channels_.push_back( c );
+		}
+		SCONE_ERROR_IF( !channels_.empty() && samples_ < 2, "Number of normalized samples must be at least 2" );
+		row_size_ = 1 + channels_.size();
 
-	std::vector<GaitCycle> ExtractGaitCycles( const Storage<>& sto, const GaitCycleExtractionSettings& opt  )
-	{
-		std::vector<GaitCycle> cycles;
 		for ( auto side : { Side::Left, Side::Right } )
 		{
+			auto& s = sides_[side == Side::Left ? 0 : 1];
+			s.side_ = side;
 			string leg_name = ( side == Side::Left ) ? "leg0_l" : "leg1_r";
-			index_t grf_chan = sto.TryGetChannelIndex( leg_name + ".grf_norm_y" );
-			index_t cop_chan = sto.TryGetChannelIndex( leg_name + ".cop_x" );
-
-			if ( grf_chan == no_index || cop_chan == no_index ) {
+			s.grf_chan_ = find_label( leg_name + ".grf_norm_y" );
+			s.cop_chan_ = find_label( leg_name + ".cop_x" );
+			if ( s.grf_chan_ == no_index || s.cop_chan_ == no_index )
 				log::debug( "Could not find grf_norm and cop channel for ", leg_name );
-				continue;
+			if ( !channels_.empty() ) {
+				s.normalized_.resize( samples_ * channels_.size() );
+				s.stat_mean_.resize( samples_ * channels_.size() );
+				s.stat_m2_.resize( samples_ * channels_.size() );
 			}
+		}
+	}
+
+	void GaitCycleExtractor::AddFrame( TimeInSeconds time, const Real* values )
+	{
+		for ( auto& s : sides_ )
+			if ( s.grf_chan_ != no_index && s.cop_chan_ != no_index )
+				AddFrame( s, time, values );
+	}
+
+	void GaitCycleExtractor::AddFrame( SideState& s, TimeInSeconds time, const Real* values )
+	{
+		const bool touch = values[s.grf_chan_] > opt_.touch_force_threshold;
 
-			// skip to first touch down
-			index_t flight_idx = FindNextFlight( sto, 0u, grf_chan, opt.touch_force_threshold );
-			index_t touch_idx = FindNextTouch( sto, flight_idx, grf_chan, opt.touch_force_threshold );
+		// buffer data as long as there is a pending or current cycle
+		if ( !channels_.empty() && ( s.pending_ || s.phase_ == Phase::WaitSwing || s.phase_ == Phase::WaitEnd || ( touch && s.phase_ == Phase::WaitTouch ) ) ) {
+			s.buffer_.push_back( time );
+			for ( auto idx : channel_indices_ )
+				s.buffer_.push_back( values[idx] );
+		}
 
-			while ( touch_idx != no_index && touch_idx < sto.GetFrameCount() )
+		switch ( s.phase_ )
+		{
+		case Phase::WaitFlight: // skip to first flight phase
+			if ( !touch )
+				s.phase_ = Phase::WaitTouch;
+			break;
+		case Phase::WaitTouch: // first touch down
+			if ( touch ) {
+				s.begin_ = time;
+				s.begin_pos_ = Vec3( values[s.cop_chan_], values[s.cop_chan_ + 1], values[s.cop_chan_ + 2] );
+				s.phase_ = Phase::WaitSwing;
+			}
+			break;
+		case Phase::WaitSwing:
+			if ( !touch ) {
+				s.swing_ = time;
+				s.phase_ = Phase::WaitEnd;
+			}
+			break;
+		case Phase::WaitEnd:
+			if ( touch ) {
+				Vec3 end_pos( values[s.cop_chan_], values[s.cop_chan_ + 1], values[s.cop_chan_ + 2] );
+				AddCycle( s, time, end_pos );
+
+				// the end of this cycle is the beginning of the next
+				s.begin_ = time;
+				s.begin_pos_ = end_pos;
+				s.phase_ = Phase::WaitSwing;
+				TrimBuffer( s, s.pending_ ? s.cycles_.back().begin_ : s.begin_ );
+			}
+			break;
+		}
+	}
+
+	void GaitCycleExtractor::AddCycle( SideState& s, TimeInSeconds end_time, const Vec3& end_pos )
+	{
+		if ( s.swing_ - s.begin_ < opt_.min_swing_duraction )
+		{
+			// the stance was just a bump, add it to the previous cycle
+			if ( s.pending_ )
 			{
-				auto begin_time = sto.GetFrame( touch_idx ).GetTime();
-				auto begin_pos = sto.GetFrame( touch_idx ).GetVec3( cop_chan );
+				s.cycles_.back().end_ = end_time;
+				s.cycles_.back().end_pos_ = end_pos;
+				log::trace( "U: ", s.cycles_.back() );
+			}
+		}
+		else
+		{
+			if ( s.pending_ )
+				ProcessCycle( s, s.cycles_.back() );
+			s.cycles_.emplace_back( GaitCycle{ s.side_, s.begin_, s.swing_, end_time, s.begin_pos_, end_pos } );
+			s.pending_ = true;
+			log::trace( "N: ", s.cycles_.back() );
+		}
+	}
 
-				flight_idx = FindNextFlight( sto, touch_idx, grf_chan, opt.touch_force_threshold );
-				if ( flight_idx == no_index )
-					break;
-				auto swing_time = sto.GetFrame( flight_idx ).GetTime();
+	void GaitCycleExtractor::ProcessCycle( SideState& s, const GaitCycle& cycle )
+	{
+		if ( channels_.empty() )
+			return;
 
-				touch_idx = FindNextTouch( sto, flight_idx, grf_chan, opt.touch_force_threshold );
-				if ( touch_idx == no_index )
-					break;
-				auto end_time = sto.GetFrame( touch_idx ).GetTime();
-				auto end_pos = sto.GetFrame( touch_idx ).GetVec3( cop_chan );
-
-				if ( swing_time - begin_time < opt.min_swing_duraction )
-				{
-					// the stance was just a bump
-					if ( !cycles.empty() && cycles.back().side_ == side )
-					{
-						// add it to the previous cycle
-						cycles.back().end_ = end_time;
-						cycles.back().end_pos_ = end_pos;
-						log::trace( "U: ", cycles.back() );
-					}
-				}
-				else
-				{
-					cycles.emplace_back( GaitCycle{ side, begin_time, swing_time, end_time, begin_pos, end_pos } );
-					log::trace( "N: ", cycles.back() );
-				}
+		// resample buffered data, using the same interpolation as Storage::ComputeInterpolatedFrame()
+		const size_t rows = s.buffer_.size() / row_size_;
+		const size_t nchan = channels_.size();
+		SCONE_ASSERT( rows > 0 );
+		size_t upper = 0;
+		for ( index_t si = 0; si < samples_; ++si )
+		{
+			auto t = cycle.begin_ + si * cycle.duration() / ( samples_ - 1 );
+			while ( upper < rows && s.buffer_[upper * row_size_] <= t )
+				++upper;
+			auto* nv = &s.normalized_[si * nchan];
+			if ( upper == rows || upper == 0 ) {
+				auto* v = &s.buffer_[( upper == rows ? rows - 1 : 0 ) * row_size_ + 1];
+				std::copy( v, v + nchan, nv );
 			}
+			else {
+				auto* v0 = &s.buffer_[( upper - 1 ) * row_size_];
+				auto* v1 = &s.buffer_[upper * row_size_];
+				double w = ( t - v0[0] ) / ( v1[0] - v0[0] );
+				for ( index_t ci = 0; ci < nchan; ++ci )
+					nv[ci] = w * v1[ci + 1] + ( 1.0 - w ) * v0[ci + 1];
+			}
+		}
+
+		// update running mean and variance
+		s.stat_count_++;
+		for ( index_t i = 0; i < s.normalized_.size(); ++i ) {
+			double delta = s.normalized_[i] - s.stat_mean_[i];
+			s.stat_mean_[i] += delta / s.stat_count_;
+			s.stat_m2_[i] += delta * ( s.normalized_[i] - s.stat_mean_[i] );
 		}
+
+		if ( cycle_func_ )
+			cycle_func_( cycle, s.normalized_ );
+	}
+
+	void GaitCycleExtractor::TrimBuffer( SideState& s, TimeInSeconds time )
+	{
+		if ( channels_.empty() )
+			return;
+		size_t first_row = 0;
+		while ( ( first_row + 1 ) * row_size_ <= s.buffer_.size() && s.buffer_[first_row * row_size_] < time )
+			++first_row;
+		s.buffer_.erase( s.buffer_.begin(), s.buffer_.begin() + first_row * row_size_ );
+	}
+
+	void GaitCycleExtractor::Finish()
+	{
+		for ( auto& s : sides_ ) {
+			if ( s.pending_ ) {
+				ProcessCycle( s, s.cycles_.back() );
+				s.pending_ = false;
+				TrimBuffer( s, s.begin_ );
+			}
+		}
+	}
+
+	std::vector<GaitCycle> GaitCycleExtractor::GetCycles() const
+	{
+		std::vector<GaitCycle> cycles;
+		for ( auto& s : sides_ )
+			cycles.insert( cycles.end(), s.cycles_.begin(), s.cycles_.end() );
 		std::sort( cycles.begin(), cycles.end(), []( auto&& a, auto&& b ) { return a.begin_ < b.begin_; } );
 
 		// compute prev_opposite_end_pos for all cycles
@@ -79,6 +196,33 @@ namespace scone
 
 		return cycles;
 	}
+
+	Storage<> GaitCycleExtractor::GetNormalizedStatistics( Side side ) const
+	{
+		const auto& s = GetSideState( side );
+		Storage<> sto;
+		for ( const auto& c : channels_ )
+			sto.AddChannel( c );
+		for ( const auto& c : channels_ )
+			sto.AddChannel( c + ".std" );
+		const size_t nchan = channels_.size();
+		for ( index_t si = 0; si < samples_ && s.stat_count_ > 0; ++si ) {
+			auto& f = sto.AddFrame( 100.0 * si / ( samples_ - 1 ) );
+			for ( index_t ci = 0; ci < nchan; ++ci ) {
+				f[ci] = s.stat_mean_[si * nchan + ci];
+				f[nchan + ci] = std::sqrt( s.stat_m2_[si * nchan + ci] / s.stat_count_ );
+			}
+		}
+		return sto;
+	}
+
+	std::vector<GaitCycle> ExtractGaitCycles( const Storage<>& sto, const GaitCycleExtractionSettings& opt  )
+	{
+		GaitCycleExtractor gce( sto.GetLabels(), opt );
+		for ( const auto& f : sto.GetData() )
+			gce.AddFrame( f );
+		return gce.GetCycles();
+	}
 }
 
 xo::string xo::to_str( const scone::GaitCycle& c )
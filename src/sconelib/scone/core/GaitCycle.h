@@ -6,6 +6,7 @@
 #include "Storage.h"
 #include "scone/core/string_tools.h"
 #include "xo/geometry/geometry_algorithms.h"
+#include <functional>
 
 namespace scone
 {
@@ -34,6 +35,73 @@ namespace scone
 	};
 
 	SCONE_API std::vector<GaitCycle> ExtractGaitCycles( const Storage<>& sto, const GaitCycleExtractionSettings& opt );
+
+	/// Streaming gait cycle extraction, which processes frames one by one without storing all data.
+	/// Produces the same cycles as ExtractGaitCycles(). Optionally, the data of specific channels is resampled
+	/// to 0-100% of each completed gait cycle, which is passed to a callback and added to running statistics.
+	class SCONE_API GaitCycleExtractor
+	{
+	public:
+		using CycleFunction = std::function< void( const GaitCycle& cycle, const std::vector<Real>& normalized_data ) >;
+
+		// labels are the channel names of the frames, channels are the names of the channels to normalize
+		GaitCycleExtractor( const std::vector<String>& labels, const GaitCycleExtractionSettings& opt,
+			const std::vector<String>& channels = {}, size_t samples = 201 );
+
+		// process a single frame, values are ordered according to labels
+		void AddFrame( TimeInSeconds time, const Real* values );
+		void AddFrame( const Storage<>::Frame& f ) { AddFrame( f.GetTime(), f.GetValues().data() ); }
+
+		// process remaining cycles, call after the last frame
+		void Finish();
+
+		// set callback for completed cycles; normalized_data is ordered [sample][channel]
+		// opposite_end_pos_ is only available via GetCycles()
+		void SetCycleFunction( CycleFunction f ) { cycle_func_ = std::move( f ); }
+
+		// all completed cycles so far, sorted by begin time
+		std::vector<GaitCycle> GetCycles() const;
+
+		// average and standard deviation of normalized channel data, with time in [0, 100] % gait cycle
+		Storage<> GetNormalizedStatistics( Side side ) const;
+		size_t GetNormalizedCycleCount( Side side ) const { return GetSideState( side ).stat_count_; }
+
+		const std::vector<String>& GetChannels() const { return channels_; }
+		size_t GetSampleCount() const { return samples_; }
+
+	private:
+		enum class Phase { WaitFlight, WaitTouch, WaitSwing, WaitEnd };
+		struct SideState {
+			Side side_ = Side::None;
+			index_t grf_chan_ = no_index;
+			index_t cop_chan_ = no_index;
+			Phase phase_ = Phase::WaitFlight;
+			TimeInSeconds begin_ = 0;
+			TimeInSeconds swing_ = 0;
+			Vec3 begin_pos_;
+			std::vector<GaitCycle> cycles_; // last cycle is pending, it can be extended with bumps
+			bool pending_ = false;
+			std::vector<Real> buffer_; // rows of [time, channels...], starting at first pending or current cycle
+			std::vector<Real> normalized_;
+			size_t stat_count_ = 0;
+			std::vector<double> stat_mean_;
+			std::vector<double> stat_m2_;
+		};
+
+		const SideState& GetSideState( Side side ) const { return side == Side::Left ? sides_[0] : sides_[1]; }
+		void AddFrame( SideState& s, TimeInSeconds time, const Real* values );
+		void AddCycle( SideState& s, TimeInSeconds end_time, const Vec3& end_pos );
+		void ProcessCycle( SideState& s, const GaitCycle& cycle );
+		void TrimBuffer( SideState& s, TimeInSeconds time );
+
+		GaitCycleExtractionSettings opt_;
+		std::vector<index_t> channel_indices_;
+		std::vector<String> channels_;
+		size_t samples_;
+		size_t row_size_;
+		SideState sides_[2];
+		CycleFunction cycle_func_;
+	};
 }
 
 namespace xo
@@ -0,0 +1,105 @@
+/*
+** ModelArena.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "ModelArena.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace scone
+{
+	namespace
+	{
+		thread_local ModelArena* g_ActiveArena = nullptr;
+		std::atomic< size_t > g_PrematureDestructionCount = 0;
+
+		// each ArenaAllocated object is preceded by a header with its arena, or nullptr if it is on the heap
+		constexpr size_t alignment = alignof( std::max_align_t );
+		constexpr size_t header_size = sizeof( std::max_align_t );
+		static_assert( sizeof( ModelArena* ) <= header_size );
+
+		size_t AlignedSize( size_t size ) { return ( size + alignment - 1 ) / alignment * alignment; }
+	}
+
+	ModelArena::ModelArena( size_t block_size ) :
+		m_BlockSize( AlignedSize( std::max< size_t >( block_size, alignment ) ) ),
+		m_Pos( nullptr ),
+		m_Available( 0 ),
+		m_MemorySize( 0 ),
+		m_ObjectCount( 0 )
+	{}
+
+	ModelArena::~ModelArena()
+	{
+		if ( m_ObjectCount > 0 ) {
+			++g_PrematureDestructionCount;
+			log::error( "ModelArena destroyed before ", m_ObjectCount, " of its objects" );
+		}
+	}
+
+	size_t ModelArena::GetPrematureDestructionCount()
+	{
+		return g_PrematureDestructionCount;
+	}
+
+	void* ModelArena::Allocate( size_t size )
+	{
+		size = AlignedSize( std::max< size_t >( size, 1 ) );
+		if ( size > m_Available )
+		{
+			// start a new block, allocations larger than the block size get their own block
+			const auto block_size = std::max( size, m_BlockSize );
+			m_Blocks.emplace_back( new std::max_align_t[block_size / sizeof( std::max_align_t )] );
+			m_Pos = reinterpret_cast<std::byte*>( m_Blocks.back().get() );
+			m_Available = block_size;
+			m_MemorySize += block_size;
+		}
+		auto* p = m_Pos;
+		m_Pos += size;
+		m_Available -= size;
+		return p;
+	}
+
+	ModelArena* ModelArena::GetActive()
+	{
+		return g_ActiveArena;
+	}
+
+	ModelArenaScope::ModelArenaScope( ModelArena* arena ) :
+		m_Previous( g_ActiveArena )
+	{
+		g_ActiveArena = arena;
+	}
+
+	ModelArenaScope::~ModelArenaScope()
+	{
+		g_ActiveArena = m_Previous;
+	}
+
+	void* ArenaAllocated::operator new( size_t size )
+	{
+		auto* arena = ModelArena::GetActive();
+		auto* p = static_cast<std::byte*>( arena ? arena->Allocate( header_size + size ) : ::operator new( header_size + size ) );
+		*reinterpret_cast<ModelArena**>( p ) = arena;
+		if ( arena )
+			++arena->m_ObjectCount;
+		return p + header_size;
+	}
+
+	void ArenaAllocated::operator delete( void* p ) noexcept
+	{
+		if ( !p )
+			return;
+		auto* header = static_cast<std::byte*>( p ) - header_size;
+		if ( auto* arena = *reinterpret_cast<ModelArena**>( header ) )
+			--arena->m_ObjectCount; // arena memory is released when the arena is destroyed
+		else ::operator delete( header );
+	}
+}
@@ -0,0 +1,81 @@
+/*
+** ModelArena.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "platform.h"
+#include "types.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace scone
+{
+	/// Monotonic memory arena for the object graph of a single Model.
+	/// Objects derived from ArenaAllocated that are created while a ModelArenaScope is active are stored
+	/// contiguously in the arena. Deleting these objects does not release memory; all memory is released
+	/// at once when the arena is destroyed, which must happen after all objects in it are destroyed.
+	/// The scope is only active during model construction (see ModelObjective::CreateModelFromParams);
+	/// objects created afterwards, such as sensors from Model::AcquireSensor() and the controllers and
+	/// measures created by Model::Reparameterize(), are allocated on the heap. Memory of controllers and
+	/// measures that are replaced is kept in the arena until the model is destroyed.
+	class SCONE_API ModelArena
+	{
+	public:
+		ModelArena( size_t block_size = 64 * 1024 );
+		ModelArena( const ModelArena& ) = delete;
+		ModelArena& operator=( const ModelArena& ) = delete;
+		~ModelArena();
+
+		/// Allocate size bytes, aligned to std::max_align_t.
+		void* Allocate( size_t size );
+
+		/// Total number of bytes allocated from the system.
+		size_t GetMemorySize() const { return m_MemorySize; }
+
+		/// Number of ArenaAllocated objects in this arena that have not been deleted.
+		size_t GetObjectCount() const { return m_ObjectCount; }
+
+		/// Number of arenas that were destroyed before all their objects were deleted, which is an ownership error.
+		static size_t GetPrematureDestructionCount();
+
+		/// Arena used by the current thread, or nullptr if no ModelArenaScope is active.
+		static ModelArena* GetActive();
+
+	private:
+		friend class ModelArenaScope;
+		friend struct ArenaAllocated;
+		using Block = std::unique_ptr< std::max_align_t[] >;
+		size_t m_BlockSize;
+		std::vector< Block > m_Blocks;
+		std::byte* m_Pos;
+		size_t m_Available;
+		size_t m_MemorySize;
+		size_t m_ObjectCount;
+	};
+
+	/// Allocations of ArenaAllocated objects by the current thread use arena during the lifetime of this object.
+	class SCONE_API ModelArenaScope
+	{
+	public:
+		ModelArenaScope( ModelArena* arena );
+		~ModelArenaScope();
+		ModelArenaScope( const ModelArenaScope& ) = delete;
+		ModelArenaScope& operator=( const ModelArenaScope& ) = delete;
+
+	private:
+		ModelArena* m_Previous;
+	};
+
+	/// Base class for objects that are allocated from the active ModelArena, or from the heap if there is none.
+	struct SCONE_API ArenaAllocated
+	{
+		static void* operator new( size_t size );
+		static void operator delete( void* p ) noexcept;
+	};
+}
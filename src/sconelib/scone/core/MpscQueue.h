@@ -0,0 +1,60 @@
+/*
+** MpscQueue.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace scone
+{
+	/// Unbounded lock-free multi-producer single-consumer queue (intrusive linked list, Vyukov).
+	/// push() can be called from any thread and never blocks; try_pop() must be called from one consumer at a time.
+	template< typename T >
+	class MpscQueue
+	{
+	public:
+		MpscQueue() : head_( new Node ), tail_( head_.load() ) {}
+		MpscQueue( const MpscQueue& ) = delete;
+		MpscQueue& operator=( const MpscQueue& ) = delete;
+		~MpscQueue() {
+			T value;
+			while ( try_pop( value ) );
+			delete tail_;
+		}
+
+		// add value to the queue, safe to call from multiple threads
+		void push( T&& value ) {
+			Node* node = new Node{ std::move( value ) };
+			Node* prev = head_.exchange( node, std::memory_order_acq_rel );
+			prev->next_.store( node, std::memory_order_release );
+		}
+
+		// remove the oldest value from the queue, returns false if empty; consumer only
+		bool try_pop( T& value ) {
+			Node* next = tail_->next_.load( std::memory_order_acquire );
+			if ( !next )
+				return false;
+			value = std::move( next->value_ );
+			delete tail_;
+			tail_ = next;
+			return true;
+		}
+
+		// check if the queue is empty; consumer only
+		bool empty() const { return tail_->next_.load( std::memory_order_acquire ) == nullptr; }
+
+	private:
+		struct Node {
+			T value_{};
+			std::atomic<Node*> next_{ nullptr };
+		};
+		std::atomic<Node*> head_;
+		Node* tail_;
+	};
+}
@@ -0,0 +1,27 @@
+/*
+** ParallelReduce.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "ParallelReduce.h"
+#include "Settings.h"
+
+namespace scone
+{
+	static std::atomic<size_t> g_EvaluationThreadOverride = no_size;
+
+	size_t GetEvaluationThreadCount()
+	{
+		if ( auto threads = g_EvaluationThreadOverride.load(); threads != no_size )
+			return threads;
+		return size_t( std::max( 0, GetSconeSetting<int>( "optimizer.evaluation_threads" ) ) );
+	}
+
+	void SetEvaluationThreadCount( size_t threads )
+	{
+		g_EvaluationThreadOverride = threads;
+	}
+}
@@ -0,0 +1,87 @@
+/*
+** ParallelReduce.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "platform.h"
+#include "types.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scone
+{
+	/// Maximum number of threads used for parallel work within a single evaluation.
+	/// Returns the override set by SetEvaluationThreadCount(), or else setting optimizer.evaluation_threads;
+	/// one (the default) means sequential, zero means one thread per hardware thread.
+	SCONE_API size_t GetEvaluationThreadCount();
+
+	/// Override the number of evaluation threads for this process; no_size restores the setting.
+	SCONE_API void SetEvaluationThreadCount( size_t threads );
+
+	/// Number of threads used for max_threads, where zero means one thread per hardware thread.
+	inline size_t GetThreadCount( size_t max_threads ) {
+		return max_threads > 0 ? max_threads : std::max<size_t>( 1, std::thread::hardware_concurrency() );
+	}
+
+	/// Sum of n values using a fixed pairwise tree. The order of additions only depends on n,
+	/// which makes the result reproducible regardless of how the values were computed.
+	template< typename T > T TreeSum( const T* values, size_t n ) {
+		if ( n == 0 )
+			return T();
+		if ( n == 1 )
+			return values[0];
+		size_t half = 1;
+		while ( half * 2 < n )
+			half *= 2;
+		return TreeSum( values, half ) + TreeSum( values + half, n - half );
+	}
+	template< typename T > T TreeSum( const std::vector<T>& values ) { return TreeSum( values.data(), values.size() ); }
+
+	/// Compute fn( i ) for i in [0, n) using up to max_threads threads (zero means one per hardware thread)
+	/// and return the results in index order. Provided fn( i ) only depends on i, the results
+	/// are identical for any number of threads. The first exception thrown by fn is rethrown.
+	template< typename F > auto ParallelMap( size_t n, F fn, size_t max_threads = GetEvaluationThreadCount() ) {
+		using T = decltype( fn( size_t() ) );
+		std::vector<T> results( n );
+		const auto threads = std::min( n, GetThreadCount( max_threads ) );
+		if ( threads <= 1 ) {
+			for ( size_t i = 0; i < n; ++i )
+				results[i] = fn( i );
+			return results;
+		}
+
+		std::atomic<size_t> next_index = 0;
+		std::exception_ptr error;
+		std::mutex error_mutex;
+		auto worker = [&]() {
+			for ( size_t i = next_index++; i < n; i = next_index++ ) {
+				try { results[i] = fn( i ); }
+				catch ( ... ) {
+					std::scoped_lock lock( error_mutex );
+					if ( !error )
+						error = std::current_exception();
+					next_index = n; // stop other workers
+				}
+			}
+		};
+		std::vector<std::thread> workers;
+		workers.reserve( threads - 1 );
+		for ( size_t t = 1; t < threads; ++t )
+			workers.emplace_back( worker );
+		worker();
+		for ( auto& w : workers )
+			w.join();
+		if ( error )
+			std::rethrow_exception( error );
+		return results;
+	}
+}
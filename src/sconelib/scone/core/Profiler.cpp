@@ -7,64 +7,127 @@
 */
 
 #include "Profiler.h"
+#include "AllocationTracker.h"
 #include "string_tools.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <utility>
 #include "Exception.h"
 
 namespace scone
 {
+	namespace
+	{
+		using clock = std::chrono::steady_clock;
+		const clock::time_point g_ProfilerEpoch = clock::now();
+		thread_local ProfileScopeId g_CurrentScope = Profiler::NoScope;
+		std::atomic< std::uint64_t > g_ProfilerCount = 0;
+
+		// aggregated durations of a scope at a specific position in the call hierarchy
+		struct ReportNode {
+			std::vector< HighResolutionTime > durations;
+			std::map< ProfileScopeId, ReportNode > children;
+		};
+
+		HighResolutionTime Percentile( const std::vector< HighResolutionTime >& sorted, double p ) {
+			return sorted[ std::min( sorted.size() - 1, size_t( p * sorted.size() ) ) ];
+		}
+
+		HighResolutionTime Total( const std::vector< HighResolutionTime >& durations ) {
+			HighResolutionTime total = 0;
+			for ( auto d : durations )
+				total += d;
+			return total;
+		}
+
+		HighResolutionTime ChildrenTotal( const ReportNode& node ) {
+			HighResolutionTime total = 0;
+			for ( auto& c : node.children )
+				total += Total( c.second.durations );
+			return total;
+		}
+
+		void AddReport( const Profiler& prof, ReportNode& node, PropNode& pn, double root_time ) {
+			for ( auto& [id, child] : node.children ) {
+				auto& d = child.durations;
+				std::sort( d.begin(), d.end() );
+				const auto total = Total( d );
+				const auto children_total = ChildrenTotal( child );
+				auto& cpn = pn.add_child( prof.GetScopeName( id ) );
+				cpn.set_value( stringf( "%6.2f%% (%5.2f%% exclusive) n=%zu total=%.3fms p50=%.1fus p90=%.1fus p99=%.1fus max=%.1fus",
+					100.0 * total / root_time, 100.0 * ( total - children_total ) / root_time, d.size(), 1e-6 * total,
+					1e-3 * Percentile( d, 0.5 ), 1e-3 * Percentile( d, 0.9 ), 1e-3 * Percentile( d, 0.99 ), 1e-3 * d.back() ) );
+				AddReport( prof, child, cpn, root_time );
+			}
+		}
+
+		String JsonEscaped( const char* str ) {
+			String s;
+			for ( ; *str; ++str ) {
+				if ( *str == '"' || *str == '\\' )
+					s += '\\';
+				s += *str;
+			}
+			return s;
+		}
+	}
+
+	// Per-thread event storage; only the owning thread writes, events are stored in blocks that never move.
+	struct Profiler::ThreadBuffer {
+		static constexpr size_t block_size = 4096;
+		using Block = std::array< Event, block_size >;
+
+		std::vector< std::unique_ptr< Block > > blocks; // modified only by the owning thread, while holding mutex
+		std::atomic< size_t > size = 0; // number of events that can be read
+		std::atomic< size_t > dropped = 0; // number of events that exceeded the maximum
+		std::atomic< bool > in_use = true; // cleared when the owning thread exits, after which the buffer can be reused
+		mutable std::mutex mutex;
+	};
+
 	Profiler& Profiler::GetGlobalInstance()
 	{
-		// this should be thread-safe in c++14
-		// #todo: use thread local storage, or ensure thread safety
 		static Profiler g_GlobalInstance;
 		return g_GlobalInstance;
 	}
 
-	ScopedProfile::ScopedProfile( class Profiler& prof, const String& scope ) :
-		m_Profiler( prof )
+	ProfileScopeId Profiler::GetCurrentScope()
 	{
-		if ( m_Profiler.IsActive() )
-			m_StartTime = m_Profiler.StartMeasure( scope );
+		return g_CurrentScope;
 	}
 
-	ScopedProfile::~ScopedProfile()
+	ProfileScopeId Profiler::SetCurrentScope( ProfileScopeId scope )
 	{
-		if ( m_Profiler.IsActive() )
-			m_Profiler.StopMeasure( m_StartTime );
+		return std::exchange( g_CurrentScope, scope );
 	}
 
 	Profiler::Profiler() :
-		m_Root( nullptr ),
-		m_Current( &m_Root ),
-		m_bActive( true )
-	{
-
-	}
+		m_Id( ++g_ProfilerCount ),
+		m_bActive( false ),
+		m_MaxEventsPerThread( 1 << 22 )
+	{}
 
 	Profiler::~Profiler()
-	{
-
-	}
+	{}
 
-	HighResolutionTime Profiler::StartMeasure( const String& scope )
+	ProfileScopeId Profiler::RegisterScope( const char* name )
 	{
-		m_Current = &m_Current->GetOrAddChild( scope );
-		return m_Timer().nanoseconds();
+		std::scoped_lock lock( m_Mutex );
+		for ( ProfileScopeId id = 0; id < m_ScopeNames.size(); ++id )
+			if ( std::strcmp( m_ScopeNames[id], name ) == 0 )
+				return id;
+		m_ScopeNames.push_back( name );
+		return ProfileScopeId( m_ScopeNames.size() - 1 );
 	}
 
-	void Profiler::StopMeasure( HighResolutionTime start_time )
+	const char* Profiler::GetScopeName( ProfileScopeId id ) const
 	{
-		m_Current->AddSample( m_Timer().nanoseconds() - start_time );
-		m_Current = m_Current->parent;
-	}
-
-	PropNode Profiler::GetReport()
-	{
-		PropNode pn;
-		m_Root.GetReport( pn );
-		return pn;
+		std::scoped_lock lock( m_Mutex );
+		return id < m_ScopeNames.size() ? m_ScopeNames[id] : "?";
 	}
 
 	void Profiler::Activate()
@@ -77,57 +140,157 @@ namespace scone
 		m_bActive = false;
 	}
 
-	bool Profiler::IsActive()
+	void Profiler::Reset()
 	{
-		return m_bActive;
+		std::scoped_lock lock( m_Mutex );
+		for ( auto& tb : m_ThreadBuffers )
+		{
+			std::scoped_lock tb_lock( tb->mutex );
+			tb->size = 0;
+			tb->dropped = 0;
+		}
 	}
 
-	void Profiler::Reset()
+	HighResolutionTime Profiler::Now() const
 	{
-		SCONE_ASSERT_MSG( m_Current == &m_Root, "Cannot reset while a ScopedProfile is active" );
-		m_Root.children.clear();
+		return std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - g_ProfilerEpoch ).count();
 	}
 
-	Profiler::Item::Item( Item* p ) :
-		parent( p ),
-		num_samples( 0 ),
-		inclusive_time( 0 ),
-		peak_time( 0 )
+	Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
 	{
+		// buffer of the current thread, which is released for reuse when the thread exits
+		struct Lease {
+			std::uint64_t profiler_id = 0;
+			std::shared_ptr< ThreadBuffer > buffer;
+			void Release() { if ( buffer ) buffer->in_use = false; buffer.reset(); }
+			~Lease() { Release(); }
+		};
+		thread_local Lease lease;
+
+		if ( lease.profiler_id != m_Id )
+		{
+			AllocationTrackingPause pause; // profiler bookkeeping is not part of the profiled code
+			lease.Release();
+			std::scoped_lock lock( m_Mutex );
+			auto it = std::find_if( m_ThreadBuffers.begin(), m_ThreadBuffers.end(), []( const auto& tb ) { return !tb->in_use; } );
+			if ( it == m_ThreadBuffers.end() )
+				it = m_ThreadBuffers.insert( it, std::make_shared< ThreadBuffer >() );
+			( *it )->in_use = true;
+			lease.profiler_id = m_Id;
+			lease.buffer = *it;
+		}
+		return *lease.buffer;
 	}
 
-	void Profiler::Item::AddSample( HighResolutionTime cur_time )
+	void Profiler::Record( ProfileScopeId scope, HighResolutionTime start, HighResolutionTime end )
 	{
-		++num_samples;
-		inclusive_time += cur_time;
-		peak_time = std::max( peak_time, cur_time );
+		auto& tb = GetThreadBuffer();
+		const auto idx = tb.size.load( std::memory_order_relaxed );
+		if ( idx >= m_MaxEventsPerThread )
+		{
+			tb.dropped.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+		const auto block_idx = idx / ThreadBuffer::block_size;
+		if ( block_idx == tb.blocks.size() )
+		{
+			AllocationTrackingPause pause;
+			std::scoped_lock lock( tb.mutex );
+			tb.blocks.emplace_back( std::make_unique< ThreadBuffer::Block >() );
+		}
+		( *tb.blocks[block_idx] )[idx % ThreadBuffer::block_size] = Event{ scope, start, end - start };
+		tb.size.store( idx + 1, std::memory_order_release );
 	}
 
-	Profiler::Item& Profiler::Item::GetOrAddChild( const String& scope )
+	std::vector< std::vector< Profiler::Event > > Profiler::CollectEvents() const
 	{
-		auto it = children.find( scope );
-		if ( it == children.end() )
+		std::scoped_lock lock( m_Mutex );
+		std::vector< std::vector< Event > > events;
+		for ( auto& tb : m_ThreadBuffers )
 		{
-			// create new item
-			children[scope] = std::unique_ptr< Item >( new Item( this ) );
-			it = children.find( scope );
+			std::scoped_lock tb_lock( tb->mutex );
+			const auto n = tb->size.load( std::memory_order_acquire );
+			auto& ev = events.emplace_back();
+			ev.reserve( n );
+			for ( size_t i = 0; i < n; ++i )
+				ev.push_back( ( *tb->blocks[i / ThreadBuffer::block_size] )[i % ThreadBuffer::block_size] );
 		}
-		return *it->second;
+		return events;
 	}
 
-	HighResolutionTime Profiler::Item::GetReport( PropNode& pn )
+	PropNode Profiler::GetReport() const
 	{
-		Item* topnode = this;
-		for ( ; topnode->parent && topnode->parent->parent; topnode = topnode->parent );
-		HighResolutionTime topnode_time = topnode->inclusive_time;
-		HighResolutionTime children_time = 0;
+		// reconstruct the call hierarchy per thread from nested events
+		ReportNode root;
+		for ( auto& ev : CollectEvents() )
+		{
+			std::sort( ev.begin(), ev.end(), []( const Event& a, const Event& b ) {
+				return a.start < b.start || ( a.start == b.start && a.duration > b.duration ); } );
+			std::vector< std::pair< HighResolutionTime, ReportNode* > > stack;
+			for ( const auto& e : ev )
+			{
+				while ( !stack.empty() && e.start >= stack.back().first )
+					stack.pop_back();
+				auto& parent = stack.empty() ? root : *stack.back().second;
+				auto& node = parent.children[e.scope];
+				node.durations.push_back( e.duration );
+				stack.emplace_back( e.start + e.duration, &node );
+			}
+		}
+
+		PropNode pn;
+		const auto root_time = ChildrenTotal( root );
+		if ( root_time > 0 )
+			AddReport( *this, root, pn, double( root_time ) );
 
-		// #todo: sort children first
-		for ( auto it = children.begin(); it != children.end(); ++it )
-			children_time += it->second->GetReport( pn.add_child( it->first ) );
+		size_t dropped = 0;
+		{
+			std::scoped_lock lock( m_Mutex );
+			for ( auto& tb : m_ThreadBuffers )
+				dropped += tb->dropped;
+		}
+		if ( dropped > 0 )
+			pn["dropped_events"] = dropped;
+		return pn;
+	}
+
+	size_t Profiler::GetThreadBufferCount() const
+	{
+		std::scoped_lock lock( m_Mutex );
+		return m_ThreadBuffers.size();
+	}
 
-		pn.set_value( stringf( "%6.2f (%5.2f exclusive)", 100.0 * inclusive_time / topnode_time, 100.0 * ( inclusive_time - children_time ) / topnode_time ) );
+	size_t Profiler::GetEventCount() const
+	{
+		std::scoped_lock lock( m_Mutex );
+		size_t count = 0;
+		for ( auto& tb : m_ThreadBuffers )
+			count += tb->size.load( std::memory_order_acquire );
+		return count;
+	}
 
-		return inclusive_time;
+	void Profiler::WriteChromeTrace( const path& file ) const
+	{
+		std::ofstream str( file.str() );
+		SCONE_ERROR_IF( !str.good(), "Could not open " + file.str() );
+		str << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		bool first = true;
+		const auto events = CollectEvents();
+		std::vector< String > names;
+		{
+			std::scoped_lock lock( m_Mutex );
+			for ( auto* n : m_ScopeNames )
+				names.push_back( JsonEscaped( n ) );
+		}
+		for ( size_t tidx = 0; tidx < events.size(); ++tidx )
+		{
+			str << ( first ? "\n" : ",\n" );
+			first = false;
+			str << stringf( "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"Thread %zu\"}}", tidx + 1, tidx + 1 );
+			for ( const auto& e : events[tidx] )
+				str << stringf( ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+					names[e.scope].c_str(), tidx + 1, 1e-3 * e.start, 1e-3 * e.duration );
+		}
+		str << "\n]}\n";
 	}
 }
@@ -10,63 +10,125 @@
 
 #include "platform.h"
 #include "PropNode.h"
-#include "scone/core/string_tools.h"
-#include "xo/time/timer.h"
-#include <map>
+#include "types.h"
+#include "xo/filesystem/path.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace scone
 {
 	typedef long long HighResolutionTime;
+	typedef std::uint32_t ProfileScopeId;
 
-	class SCONE_API ScopedProfile
-	{
-	public:
-		ScopedProfile( class Profiler& prof, const String& name );
-		~ScopedProfile();
-
-	private:
-		class Profiler& m_Profiler;
-		HighResolutionTime m_StartTime;
-	};
-
+	/// Tracing profiler for scopes marked with SCONE_PROFILE_FUNCTION or SCONE_PROFILE_SCOPE.
+	/// Recording is enabled at run-time using Activate(); when inactive, the cost of a scope is a single atomic load.
+	/// Each thread records events in its own buffer without locking, so all evaluation threads can be profiled at once.
+	/// The buffer of a thread that has exited is reused by the next new thread, after the events already recorded.
+	/// Results are available as an aggregated hierarchical report, or as a Chrome trace / Perfetto JSON file.
 	class SCONE_API Profiler
 	{
 	public:
-		friend class ScopedProfile;
+		struct Event {
+			ProfileScopeId scope;
+			HighResolutionTime start; // [ns] since profiler creation
+			HighResolutionTime duration; // [ns]
+		};
+
+		static constexpr ProfileScopeId NoScope = ProfileScopeId( -1 );
 
 		Profiler();
 		Profiler( const Profiler& other ) = delete;
 		Profiler& operator=( const Profiler& other ) = delete;
 		virtual ~Profiler();
 
-		PropNode GetReport();
+		// Register a scope name and get its id, called once per call site; name must stay valid
+		ProfileScopeId RegisterScope( const char* name );
+		const char* GetScopeName( ProfileScopeId id ) const;
+
 		void Activate();
 		void Suspend();
-		bool IsActive();
+		bool IsActive() const { return m_bActive.load( std::memory_order_relaxed ); }
+
+		// Remove all recorded events, must not be called while scopes are being recorded
 		void Reset();
 
+		// Maximum number of events per thread, further events are counted but not recorded
+		void SetMaxEventsPerThread( size_t n ) { m_MaxEventsPerThread = n; }
+
+		// Aggregated report per scope, containing call count, total time and duration percentiles
+		PropNode GetReport() const;
+
+		// Number of thread buffers, which is the maximum number of threads that recorded events at the same time
+		size_t GetThreadBufferCount() const;
+
+		// Number of recorded events, for all threads
+		size_t GetEventCount() const;
+
+		// Write all events in Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+		void WriteChromeTrace( const path& file ) const;
+
+		HighResolutionTime Now() const;
+		void Record( ProfileScopeId scope, HighResolutionTime start, HighResolutionTime end );
+
 		static Profiler& GetGlobalInstance();
 
+		// Innermost scope of the current thread, maintained by ScopedProfile while the global profiler is active
+		static ProfileScopeId GetCurrentScope();
+		// Set the innermost scope of the current thread, returns the previous scope
+		static ProfileScopeId SetCurrentScope( ProfileScopeId scope );
+
 	private:
-		HighResolutionTime StartMeasure( const String& scope );
-		void StopMeasure( HighResolutionTime start_time );
-
-		// #todo: move to pImpl
-		struct Item {
-			Item( Item* parent );
-			void AddSample( HighResolutionTime duration );
-			Item& GetOrAddChild( const String& scope );
-			HighResolutionTime GetReport( PropNode& pn );
-			Item* parent;
-			size_t num_samples;
-			HighResolutionTime inclusive_time;
-			HighResolutionTime peak_time;
-			std::map< String, std::unique_ptr< Item > > children;
-		};
+		struct ThreadBuffer;
+		ThreadBuffer& GetThreadBuffer();
+		std::vector< std::vector< Event > > CollectEvents() const;
+
+		const std::uint64_t m_Id; // unique for each profiler, used to detect a new profiler at the same address
+		std::atomic< bool > m_bActive;
+		size_t m_MaxEventsPerThread;
+		mutable std::mutex m_Mutex; // protects scope names and thread buffer list
+		std::vector< const char* > m_ScopeNames;
+		std::vector< std::shared_ptr< ThreadBuffer > > m_ThreadBuffers; // shared with the owning thread
+	};
+
+	/// Call site of a profiled scope, created once for each SCONE_PROFILE_SCOPE.
+	/// Keeps the profiler, so that a scope does not need to look up the global instance.
+	struct ProfileScope
+	{
+		ProfileScope( Profiler& prof, const char* name ) : profiler( prof ), id( prof.RegisterScope( name ) ) {}
+		Profiler& profiler;
+		const ProfileScopeId id;
+	};
 
-		Item m_Root;
-		Item* m_Current;
-		bool m_bActive;
-		xo::timer m_Timer;
+	/// Records the duration of a scope, if its profiler is active.
+	class ScopedProfile
+	{
+	public:
+		ScopedProfile( const ProfileScope& scope ) :
+			m_Profiler( nullptr ),
+			m_Scope( scope.id ),
+			m_ParentScope( Profiler::NoScope ),
+			m_StartTime( 0 )
+		{
+			if ( scope.profiler.IsActive() ) {
+				m_Profiler = &scope.profiler;
+				m_ParentScope = Profiler::SetCurrentScope( m_Scope );
+				m_StartTime = m_Profiler->Now();
+			}
+		}
+		~ScopedProfile() {
+			if ( m_Profiler ) {
+				m_Profiler->Record( m_Scope, m_StartTime, m_Profiler->Now() );
+				Profiler::SetCurrentScope( m_ParentScope );
+			}
+		}
+
+	private:
+		Profiler* m_Profiler; // nullptr if the profiler was inactive
+		ProfileScopeId m_Scope;
+		ProfileScopeId m_ParentScope;
+		HighResolutionTime m_StartTime;
 	};
 }
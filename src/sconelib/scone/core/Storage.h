@@ -38,17 +38,26 @@ namespace scone
 				m_Values( store.GetChannelCount(), default_value )
 			{}
 
+			Frame( Storage& store, TimeT t, std::vector< ValueT >&& values ) :
+				m_Store( &store ),
+				m_Time( t ),
+				m_Values( std::move( values ) )
+			{}
+
 			TimeT GetTime() const { return m_Time; }
 
 			ValueT& operator[]( index_t idx ) { return m_Values[idx]; }
 
 			const ValueT& operator[]( index_t idx ) const { return m_Values[idx]; }
 
-			ValueT& operator[]( const String& label ) {
+			ValueT& operator[]( const String& label ) { return m_Values[AcquireChannelIndex( label )]; }
+
+			// get the index of a channel, adds the channel if it doesn't exist
+			index_t AcquireChannelIndex( const String& label ) {
 				index_t idx = m_Store->TryGetChannelIndex( label );
 				if ( idx == NoIndex )
 					idx = m_Store->AddChannel( label );
-				return m_Values[idx];
+				return idx;
 			}
 
 			const ValueT& operator[]( const String& label ) const {
@@ -108,7 +117,7 @@ namespace scone
 			m_Data = other.m_Data;
 			for ( auto& f : m_Data )
 				f.m_Store = this; // update pointers to Storage
-			m_InterpolationCache.clear();
+			ClearInterpolationCache();
 			return *this;
 		};
 		Storage& operator=( Storage&& other ) {
@@ -117,7 +126,7 @@ namespace scone
 			m_Data = std::move( other.m_Data );
 			for ( auto& f : m_Data )
 				f.m_Store = this; // update pointers to Storage
-			m_InterpolationCache.clear();
+			ClearInterpolationCache();
 			return *this;
 		};
 
@@ -125,20 +134,20 @@ namespace scone
 		void Clear() {
 			m_Labels.clear();
 			m_LabelIndexMap.clear();
-			m_Data.clear();
-			m_InterpolationCache.clear();
+			RecycleFrames( 0 );
+			ClearInterpolationCache();
 		}
 
 		void ShrinkToSize( size_t s ) {
 			SCONE_ASSERT( s <= m_Data.size() );
-			m_Data.resize( s, Frame( *this, TimeT( 0 ) ) );
-			m_InterpolationCache.clear();
+			RecycleFrames( s );
+			ClearInterpolationCache();
 		}
 
 		void Reserve( size_t s ) {
 			SCONE_ASSERT( s >= m_Data.size() );
 			m_Data.reserve( s );
-			m_InterpolationCache.clear();
+			ClearInterpolationCache();
 		}
 
 		Storage CopySlice( size_t start, size_t size, size_t stride ) const {
@@ -157,8 +166,15 @@ namespace scone
 		Frame& AddFrame( TimeT time, ValueT default_value = ValueT( 0 ) ) {
 			SCONE_ERROR_IF( !m_Data.empty() && time <= m_Data.back().GetTime(),
 				"Timestamp is not higher than previous frame time: " + std::to_string( time ) );
-			m_Data.emplace_back( *this, time, default_value );
-			m_InterpolationCache.clear(); // cached iterators have become invalid
+			if ( !m_RecycledValues.empty() ) {
+				// reuse the values of a removed frame, which avoids an allocation
+				auto& values = m_RecycledValues.back();
+				values.assign( GetChannelCount(), default_value );
+				m_Data.emplace_back( *this, time, std::move( values ) );
+				m_RecycledValues.pop_back();
+			}
+			else m_Data.emplace_back( *this, time, default_value );
+			ClearInterpolationCache(); // cached iterators have become invalid
 			return m_Data.back();
 		}
 
@@ -299,12 +315,16 @@ namespace scone
 
 		// Get interpolated frame, check cached results first
 		InterpolatedFrame GetInterpolatedFrame( TimeT time ) {
-			auto cacheIt = m_InterpolationCache.find( time );
-			if ( cacheIt != m_InterpolationCache.end() )
-				return cacheIt->second;
+			for ( const auto& [cache_time, cache_frame] : m_InterpolationCache )
+				if ( cache_time == time )
+					return cache_frame;
 
+			// when the cache is full, the oldest entry is replaced
 			InterpolatedFrame bf = ComputeInterpolatedFrame( time );
-			m_InterpolationCache[time] = bf;
+			if ( m_InterpolationCache.size() < interpolation_cache_size )
+				m_InterpolationCache.emplace_back( time, bf );
+			else m_InterpolationCache[m_InterpolationCacheNext] = { time, bf };
+			m_InterpolationCacheNext = ( m_InterpolationCacheNext + 1 ) % interpolation_cache_size;
 
 			return bf;
 		}
@@ -318,6 +338,24 @@ namespace scone
 			return std::upper_bound( m_Data.cbegin(), m_Data.cend(), time, []( TimeT lhs, const Frame& rhs ) { return lhs < rhs.GetTime(); } );
 		}
 
-		std::map< TimeT, InterpolatedFrame > m_InterpolationCache;
+		// remove frames from index s, keeping the values of up to max_recycled_frames for reuse in AddFrame()
+		static constexpr size_t max_recycled_frames = 4096;
+		void RecycleFrames( size_t s ) {
+			for ( auto it = m_Data.begin() + s; it != m_Data.end() && m_RecycledValues.size() < max_recycled_frames; ++it )
+				m_RecycledValues.emplace_back( std::move( it->m_Values ) );
+			m_Data.erase( m_Data.begin() + s, m_Data.end() );
+		}
+
+		void ClearInterpolationCache() {
+			m_InterpolationCache.clear();
+			m_InterpolationCacheNext = 0;
+		}
+
+		// recently interpolated frames, cleared when frames are added or removed
+		// the size is fixed, because storages that are not updated can be interpolated at many different times
+		static constexpr size_t interpolation_cache_size = 8;
+		std::vector< std::pair< TimeT, InterpolatedFrame > > m_InterpolationCache;
+		size_t m_InterpolationCacheNext = 0;
+		std::vector< std::vector< ValueT > > m_RecycledValues;
 	};
 }
@@ -14,6 +14,7 @@
 #include "xo/numerical/constants.h"
 #include <sstream>
 #include <fstream>
+#include <cstdlib>
 #include "xo/utility/hash.h"
 #include "Log.h"
 
@@ -282,6 +283,74 @@ namespace scone
 		SCONE_TRY_RETHROW( ReadStorageBin( storage, str ), "Error reading " + file.str() );
 	}
 
+	void ReadStorageFramesTxt( std::istream& str, const StorageLabelsFunction& labels_func, const StorageFrameFunction& frame_func )
+	{
+		std::string line;
+		std::getline( str, line );
+		SCONE_ERROR_IF( str.fail(), "Error reading file labels" );
+		auto labels = xo::split_str( line, "\t " );
+		SCONE_ERROR_IF( labels.empty(), "Error reading file labels" );
+		labels.erase( labels.begin() ); // remove time label
+		labels_func( labels );
+
+		std::vector<Real> values( labels.size() );
+		for ( size_t row = 1; std::getline( str, line ); ++row )
+		{
+			const char* cur = line.c_str();
+			char* end = nullptr;
+			double time = std::strtod( cur, &end );
+			if ( end == cur )
+				return; // stop if timestamp could not be read
+			for ( index_t col = 0; col < values.size(); ++col ) {
+				cur = end;
+				values[col] = std::strtod( cur, &end );
+				SCONE_ERROR_IF( end == cur, stringf( "Could not read value of %s in row %zu", labels[col].c_str(), row ) );
+			}
+			frame_func( time, values );
+		}
+	}
+
+	void ReadStorageFramesBin( std::istream& str, const StorageLabelsFunction& labels_func, const StorageFrameFunction& frame_func )
+	{
+		std::string column_names;
+		std::getline( str, column_names );
+		SCONE_ERROR_IF( str.fail(), "Error reading file labels" );
+		auto labels = xo::split_str( column_names, "\t " );
+		SCONE_ERROR_IF( labels.empty(), "Error reading file labels" );
+		labels.erase( labels.begin() ); // remove time label
+		labels_func( labels );
+
+		std::vector<float> data( labels.size() + 1 );
+		std::vector<Real> values( labels.size() );
+		while ( str.read( reinterpret_cast<char*>( data.data() ), data.size() * sizeof( float ) ) )
+		{
+			std::copy( data.begin() + 1, data.end(), values.begin() );
+			frame_func( data[0], values );
+		}
+	}
+
+	void ReadStorageFrames( const xo::path& file, const StorageLabelsFunction& labels_func, const StorageFrameFunction& frame_func )
+	{
+		const auto ext = file.extension_no_dot().str();
+		auto str = std::ifstream( file.str(), ext == "stob" ? std::ios::in | std::ios::binary : std::ios::in );
+		SCONE_ERROR_IF( !str.good(), "Could not open " + file.str() );
+
+		// skip header
+		if ( ext == "sto" || ext == "stob" ) {
+			std::string line;
+			while ( line.compare( 0, 9, "endheader" ) != 0 ) {
+				std::getline( str, line );
+				SCONE_ERROR_IF( !str.good(), "Error reading " + file.str() );
+			}
+		}
+
+		if ( ext == "stob" )
+			SCONE_TRY_RETHROW( ReadStorageFramesBin( str, labels_func, frame_func ), "Error reading " + file.str() );
+		else if ( ext == "sto" || ext == "txt" )
+			SCONE_TRY_RETHROW( ReadStorageFramesTxt( str, labels_func, frame_func ), "Error reading " + file.str() );
+		else SCONE_ERROR( "Unsupported file format: " + file.str() );
+	}
+
 	void WriteStorage( const Storage< Real, TimeInSeconds >& storage, const xo::path& file, const String& name, TimeInSeconds min_interval )
 	{
 		switch ( xo::hash( file.extension_no_dot().str() ) )
@@ -13,6 +13,7 @@
 #include "xo/serialization/char_stream.h"
 #include <iosfwd>
 #include <cstdio>
+#include <functional>
 
 namespace scone
 {
@@ -34,6 +35,12 @@ namespace scone
 
 	void SCONE_API ReadStorageStob( Storage< Real, TimeInSeconds >& storage, const xo::path& file );
 
+	using StorageLabelsFunction = std::function< void( const std::vector<String>& labels ) >;
+	using StorageFrameFunction = std::function< void( TimeInSeconds time, const std::vector<Real>& values ) >;
+
+	/// read storage file frame-by-frame without keeping all data in memory, autodetect format (txt, sto or stob)
+	void SCONE_API ReadStorageFrames( const xo::path& file, const StorageLabelsFunction& labels_func, const StorageFrameFunction& frame_func );
+
 	/// read storage file, autodetect format (txt or sto)
 	void SCONE_API WriteStorage( const Storage< Real, TimeInSeconds >& storage, const xo::path& file, const String& name, TimeInSeconds min_interval = 0.0 );
 	void SCONE_API ReadStorage( Storage< Real, TimeInSeconds >& storage, const xo::path& file );
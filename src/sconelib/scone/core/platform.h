@@ -34,6 +34,12 @@ constexpr bool SCONE_DEBUG = true;
 #	define SCONE_EXPERIMENTAL_FEATURES_ENABLED 0
 #endif
 
+#ifdef SCONE_ALLOCATION_TRACKING
+#	define SCONE_ALLOCATION_TRACKING_ENABLED 1
+#else
+#	define SCONE_ALLOCATION_TRACKING_ENABLED 0
+#endif
+
 #if defined(_MSC_VER)
 #	pragma warning( disable: 4251 ) // disable W4251, unfortunately there's no nice way to do this
 #	pragma warning( 3: 5038 ) // Class member initialization order warning
@@ -1,13 +1,17 @@
 #include "profiler_config.h"
+#include "Profiler.h"
+#include <atomic>
 
 namespace scone
 {
-	static bool g_profiler_enabled = false;
+	static std::atomic< bool > g_profiler_enabled = false;
 
 	bool SetProfilerEnabled( bool enabled )
 	{
-		auto prev_value = g_profiler_enabled;
-		g_profiler_enabled = enabled;
+		auto prev_value = g_profiler_enabled.exchange( enabled );
+		if ( enabled )
+			Profiler::GetGlobalInstance().Activate();
+		else Profiler::GetGlobalInstance().Suspend();
 		return prev_value;
 	}
 
@@ -1,26 +1,24 @@
 #pragma once
 
-#pragma once
-
 #include "platform.h"
 
-#if defined SCONE_ENABLE_PROFILING
-#	include "Profiler.h"
-#	define SCONE_PROFILE_FUNCTION ScopedProfile unique_scoped_function_profile( Profiler::GetGlobalInstance(), __FUNCTION__ )
-#	define SCONE_PROFILE_SCOPE( scope_name_arg ) ScopedProfile unique_scoped_function_profile( Profiler::GetGlobalInstance(), scope_name_arg )
-#	define SCONE_PROFILE_START Profiler::GetGlobalInstance().Reset()
-#	define SCONE_PROFILE_REPORT log::info( Profiler::GetGlobalInstance().GetReport() )
-#elif defined SCONE_ENABLE_XO_PROFILING
+#if defined SCONE_ENABLE_XO_PROFILING
 #	include "xo/system/profiler.h"
 #	define SCONE_PROFILE_FUNCTION( profiler ) xo::scoped_profiler_section scoped_profile_var( __FUNCTION__, profiler )
 #	define SCONE_PROFILE_SCOPE( profiler, scope_name_arg ) xo::scoped_profiler_section scoped_profile_var( scope_name_arg, profiler )
-#else 
-#	define SCONE_PROFILE_FUNCTION( profiler ) void()
-#	define SCONE_PROFILE_SCOPE( profiler, scope_name_arg ) void()
+#else
+// scopes are recorded by the global scone::Profiler, which is inactive by default (see SetProfilerEnabled)
+// the profiler argument is only used when SCONE_ENABLE_XO_PROFILING is defined
+#	include "Profiler.h"
+#	define SCONE_PROFILE_FUNCTION( profiler ) SCONE_PROFILE_SCOPE( profiler, __FUNCTION__ )
+#	define SCONE_PROFILE_SCOPE( profiler, scope_name_arg ) \
+		static const ::scone::ProfileScope scone_profile_scope( ::scone::Profiler::GetGlobalInstance(), scope_name_arg ); \
+		::scone::ScopedProfile scone_scoped_profile( scone_profile_scope )
 #endif
 
 namespace scone
 {
+	// Enable or disable profiling at run-time, returns the previous value
 	SCONE_API bool SetProfilerEnabled( bool enabled );
 	SCONE_API bool GetProfilerEnabled();
 }
@@ -53,12 +53,16 @@ results {
 }
 
 optimizer {
-	evaluator { type = number label = "Evaluate sync=0, batch=1, async=2, pool=3" default = 3 }
-	max_threads { type = number label = "Max optimization threads (0=hardware)" default = 0 }
+	evaluator { type = number label = "Evaluate sync=0, batch=1, async=2, pool=3, process=4" default = 3 }
+	max_threads { type = number label = "Max optimization threads or worker processes (0=hardware)" default = 0 }
+	evaluation_threads { type = number label = "Max threads used within a single evaluation (1=sequential, 0=hardware)" default = 1 }
+	worker_command { type = string label = "Worker executable for process evaluation (empty=sconecmd)" default = "" }
+	worker_timeout { type = number label = "Seconds a worker process may take to start or evaluate, after which it is restarted (0=no limit)" default = 300 }
 	thread_priority{ type = number label = "thread priority: 0-6 (default=2)" default = 2 }
 	output_fitness_history { type = bool default = 1 label = "Output fitness history to history.txt" }
 	output_par_history { type = bool default = 0 label = "Output parameter history to history_par.txt" }
 	output_individual_search_points { type = bool default = 0 label = "Output .par files for all search points (use for debugging only)" }
+	async_file_output { type = bool default = 0 label = "Write optimization output files from a background thread" }
 }
 
 hyfydy{
@@ -48,6 +48,7 @@ namespace scone
 	SCONE_DECLARE_CLASS_AND_PTR( UserInput );
 	SCONE_DECLARE_CLASS_AND_PTR( Controller );
 	SCONE_DECLARE_CLASS_AND_PTR( Leg );
+	SCONE_DECLARE_CLASS_AND_PTR( GaitTracker );
 	SCONE_DECLARE_STRUCT_AND_PTR( Sensor );
 	SCONE_DECLARE_STRUCT_AND_PTR( SensorDelayAdapter );
 	SCONE_DECLARE_CLASS_AND_PTR( Optimizer );
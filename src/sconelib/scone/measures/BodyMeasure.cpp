@@ -84,6 +84,13 @@ namespace scone
 		position.Reset(); velocity.Reset(); angular_velocity.Reset(); acceleration.Reset();
 	}
 
+	SimulationStage BodyMeasure::GetRequiredStage() const
+	{
+		if ( !acceleration.IsNull() || !angular_acceleration.IsNull() )
+			return SimulationStage::Acceleration;
+		else return Measure::GetRequiredStage();
+	}
+
 	UpdateResult BodyMeasure::UpdateMeasure( const Model& model, double timestamp )
 	{
 		if ( !position.IsNull() )
@@ -120,6 +120,14 @@ namespace scone
 			c->Reset( model );
 	}
 
+	SimulationStage CompositeMeasure::GetRequiredStage() const
+	{
+		auto stage = Measure::GetRequiredStage();
+		for ( auto& m : m_Measures )
+			stage = std::max( stage, m->GetRequiredStage() );
+		return stage;
+	}
+
 	String CompositeMeasure::GetClassSignature() const
 	{
 		std::vector< String > strset;
@@ -59,6 +59,7 @@ namespace scone
 		virtual double ComputeResult( const Model& model ) override;
 		virtual double GetCurrentResult( const Model& model ) override;
 		virtual void Reset( Model& model ) override;
+		virtual SimulationStage GetRequiredStage() const override;
 
 		const PropNode* Measures;
 
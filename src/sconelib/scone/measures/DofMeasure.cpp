@@ -86,6 +86,13 @@ namespace scone
 		position.Reset(); velocity.Reset(); acceleration.Reset(); limit_torque.Reset(); actuator_torque.Reset();
 	}
 
+	SimulationStage DofMeasure::GetRequiredStage() const
+	{
+		if ( !acceleration.IsNull() && !use_average_acceleration_per_frame )
+			return SimulationStage::Acceleration;
+		else return Measure::GetRequiredStage();
+	}
+
 	UpdateResult DofMeasure::UpdateMeasure( const Model& model, double timestamp )
 	{
 		Real dt = timestamp - prev_time;
@@ -93,7 +100,8 @@ namespace scone
 		Real acc = 0.0;
 		if ( use_average_acceleration_per_frame )
 			acc = dt > 0.0 ? ( vel - prev_velocity ) / dt : 0.0;
-		else acc = ConvertDofValue( dof.GetAcc() + ( parent ? parent->GetAcc() : 0 ) );
+		else if ( !acceleration.IsNull() )
+			acc = ConvertDofValue( dof.GetAcc() + ( parent ? parent->GetAcc() : 0 ) );
 
 		if ( !position.IsNull() )
 			position.AddSample( timestamp, ConvertDofValue( dof.GetPos() + ( parent ? parent->GetPos() : 0 ) ) );
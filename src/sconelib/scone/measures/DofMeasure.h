@@ -45,6 +45,7 @@ namespace scone
 		virtual double ComputeResult( const Model& model ) override;
 		virtual double GetCurrentResult( const Model& model ) override;
 		virtual void Reset( Model& model ) override;
+		virtual SimulationStage GetRequiredStage() const override;
 
 		/// Dof to which to apply the penalty to.
 		Dof& dof;
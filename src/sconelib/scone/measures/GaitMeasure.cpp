@@ -9,18 +9,25 @@
 #include "GaitMeasure.h"
 #include "scone/model/Model.h"
 #include "scone/model/Body.h"
+#include "scone/model/GaitTracker.h"
 #include "scone/core/Log.h"
 #include "scone/model/Muscle.h"
 #include "scone/core/profiler_config.h"
 #include "scone/core/Range.h"
-#include "xo/container/sorted_vector.h"
 #include "xo/container/container_algorithms.h"
 #include "xo/geometry/dynvec.h"
+#include <algorithm>
+#include <array>
 
 namespace scone
 {
 	GaitMeasure::GaitMeasure( const PropNode& props, Params& par, const Model& model, const Location& loc ) :
-		Measure( props, par, model, loc )
+		Measure( props, par, model, loc ),
+		m_StepCount( 0 ),
+		m_LastStep{ 0.0, 0.0, 0.0 },
+		m_StepMeasure( 0.0 ),
+		m_StepLength( 0.0 ),
+		m_StepTime( 0.0 )
 	{
 		INIT_PROP( props, termination_height, 0.5 );
 		INIT_PROP( props, use_height_wrt_feet, false );
@@ -58,6 +65,8 @@ namespace scone
 
 		m_InitGaitDist = m_PrevGaitDist = GetGaitDist( model );
 		m_InitComHeight = use_height_wrt_feet ? model.GetComHeightWrtFeet() : model.GetComHeight();
+		m_ContactDetector = model.GetGaitTracker().AddContactDetector( load_threshold );
+		m_InitialSteps.reserve( 2 * GetInitiationSteps() );
 	}
 
 	UpdateResult GaitMeasure::UpdateMeasure( const Model& model, double timestamp )
@@ -77,8 +86,8 @@ namespace scone
 			return GetName() + ": termination_height reached";
 
 		// update min_velocity measure on new step
-		bool new_contact = HasNewFootContact( model );
-		TimeInSeconds dt = steps_.empty() ? timestamp : timestamp - steps_.back().time;
+		bool new_contact = model.GetGaitTracker().UpdateContactDetector( model, m_ContactDetector );
+		TimeInSeconds dt = m_StepCount == 0 ? timestamp : timestamp - m_LastStep.time;
 		if ( new_contact && dt > min_step_duration )
 			AddStep( model, timestamp );
 
@@ -91,36 +100,27 @@ namespace scone
 		// #todo: only when not at the end of the simulation?
 		AddStep( model, model.GetTime() );
 
-		// precompute some values
-		double distance = GetGaitDist( model ) - m_InitGaitDist;
-		double speed = distance / model.GetTime();
 		double duration = model.GetSimulationEndTime();
-		size_t step_count = steps_.size();
-
-		// compute measure based on step data
 		double step_measure = 0.0;
 		double step_length = 0.0;
-		double step_duration = 0.0;
 		double step_time = 0.0;
-		int start_step = xo::clamped( int( step_count ) - initiation_steps, 0, initiation_steps );
-		size_t counted_steps = 0;
-		for ( int step = 0; step < step_count; ++step )
+		if ( m_StepCount >= 2 * GetInitiationSteps() )
 		{
-			double dt = step > 0 ? steps_[step].time - steps_[step - 1].time : steps_[step].time;
-			double step_vel = steps_[step].length / dt;
-			double step_penalty = Range< double >( min_velocity, max_velocity ).GetRangeViolation( step_vel );
-			double norm_vel = GetNormalizedVelocity( step_penalty );
-
-			log::TraceF( "%.3f: step=%d vel=%.3f (%.3f/%.3f) penalty=%.3f norm_vel=%.3f %s",
-				steps_[step].time, step, step_vel, steps_[step].length, dt, step_penalty, norm_vel, step < start_step ? "" : "*" );
-
-			if ( step >= start_step )
+			// all steps after initiation_steps count, use running sums
+			step_measure = m_StepMeasure;
+			step_length = m_StepLength;
+			step_time = m_StepTime;
+		}
+		else
+		{
+			// not enough steps, all steps are stored
+			size_t start_step = size_t( std::max( 0, int( m_StepCount ) - initiation_steps ) );
+			for ( size_t step = start_step; step < m_StepCount; ++step )
 			{
-				step_measure += dt * norm_vel;
-				step_time += dt;
-				step_length += steps_[step].length;
-				step_duration += dt;
-				counted_steps++;
+				const auto& s = m_InitialSteps[step];
+				step_measure += s.duration * GetStepNormalizedVelocity( s );
+				step_time += s.duration;
+				step_length += s.length;
 			}
 		}
 
@@ -129,41 +129,55 @@ namespace scone
 
 		// set results
 		report_.set( "step_velocity", step_length / step_time );
-		report_.set( "step_count", step_count );
+		report_.set( "step_count", m_StepCount );
 
 		return 1.0 - step_measure / step_time;
 	}
 
 	double GaitMeasure::GetCurrentResult( const Model& model )
 	{
-		double step_vel = steps_.empty() ? 0 : steps_.back().length / GetStepDuration( steps_.size() - 1 );
-		double step_penalty = Range< double >( min_velocity, max_velocity ).GetRangeViolation( step_vel );
-		double norm_vel = GetNormalizedVelocity( step_penalty );
-		return norm_vel;
+		if ( m_StepCount == 0 )
+			return GetNormalizedVelocity( Range< double >( min_velocity, max_velocity ).GetRangeViolation( 0.0 ) );
+		return GetStepNormalizedVelocity( m_LastStep );
 	}
 
 	void GaitMeasure::Reset( Model& model )
 	{
 		Measure::Reset( model );
-		steps_.clear();
-		m_PrevContactState.clear();
+		m_StepCount = 0;
+		m_LastStep = Step{ 0.0, 0.0, 0.0 };
+		m_InitialSteps.clear();
+		m_StepMeasure = m_StepLength = m_StepTime = 0.0;
 		m_PrevGaitDist = 0.0;
 		m_Report.clear();
 	}
 
 	void GaitMeasure::StoreData( Storage<Real>::Frame& frame, const StoreDataFlags& flags ) const
 	{
-		frame["step_length"] = steps_.empty() ? 0 : steps_.back().length;
-		frame["step_velocity"] = steps_.empty() ? 0 : steps_.back().length / GetStepDuration( steps_.size() - 1 );
+		frame["step_length"] = m_StepCount == 0 ? 0 : m_LastStep.length;
+		frame["step_velocity"] = m_StepCount == 0 ? 0 : m_LastStep.length / m_LastStep.duration;
 	}
 
 	void GaitMeasure::AddStep( const Model& model, double timestamp )
 	{
 		double gait_dist = GetGaitDist( model );
 		double step_length = gait_dist - m_PrevGaitDist;
-
-		steps_.emplace_back( Step{ model.GetTime(), step_length } );
+		double step_duration = m_StepCount > 0 ? model.GetTime() - m_LastStep.time : model.GetTime();
+		m_LastStep = Step{ model.GetTime(), step_length, step_duration };
 		m_PrevGaitDist = gait_dist;
+
+		// keep initial steps, in case there are too few steps to skip initiation_steps
+		if ( m_StepCount < 2 * GetInitiationSteps() )
+			m_InitialSteps.emplace_back( m_LastStep );
+
+		// update running sums for steps that count when there are enough steps
+		if ( m_StepCount >= GetInitiationSteps() )
+		{
+			m_StepMeasure += step_duration * GetStepNormalizedVelocity( m_LastStep );
+			m_StepTime += step_duration;
+			m_StepLength += step_length;
+		}
+		++m_StepCount;
 	}
 
 	Real GaitMeasure::GetNormalizedVelocity( Real p )
@@ -173,53 +187,29 @@ namespace scone
 		return xo::clamped( 1.0 - ( fabs( p ) / norm_vel ), -1.0, 1.0 );
 	}
 
+	Real GaitMeasure::GetStepNormalizedVelocity( const Step& s )
+	{
+		double step_vel = s.length / s.duration;
+		double step_penalty = Range< double >( min_velocity, max_velocity ).GetRangeViolation( step_vel );
+		return GetNormalizedVelocity( step_penalty );
+	}
+
 	Real GaitMeasure::GetGaitDist( const Model& model )
 	{
 		// compute average of feet and Com (smallest 2 values)
 		SCONE_ASSERT( m_BaseBodies.size() >= 2 );
-		xo::sorted_vector< double > distances;
-		distances.reserve( 3 );
-		distances.insert( xo::dot_product( direction, model.GetComPos() ) );
-		distances.insert( xo::dot_product( direction, m_BaseBodies[0]->GetComPos() ) );
-		distances.insert( xo::dot_product( direction, m_BaseBodies[1]->GetComPos() ) );
+		std::array< double, 3 > distances{
+			xo::dot_product( direction, model.GetComPos() ),
+			xo::dot_product( direction, m_BaseBodies[0]->GetComPos() ),
+			xo::dot_product( direction, m_BaseBodies[1]->GetComPos() ) };
+		std::sort( distances.begin(), distances.end() );
 		auto dist = ( distances[0] + distances[1] ) / 2;
 		auto ground_dist = xo::dot_product( direction, model.GetGroundBody().GetOriginPos() );
 		return dist - ground_dist;
 	}
 
-	Real GaitMeasure::GetStepDuration( index_t step ) const
-	{
-		if ( steps_.empty() )
-			return 0.0;
-		else if ( step == 0 )
-			return steps_.front().time;
-		SCONE_ASSERT( steps_.size() > step );
-		return steps_[step].time - steps_[step - 1].time;
-	}
-
 	String GaitMeasure::GetClassSignature() const
 	{
 		return stringf( "S%02d", static_cast<int>( 10 * min_velocity ) );
 	}
-
-	bool GaitMeasure::HasNewFootContact( const Model& model )
-	{
-		if ( m_PrevContactState.empty() )
-		{
-			// initialize
-			for ( const auto& leg : model.GetLegs() )
-				m_PrevContactState.push_back( leg.GetLoad() >= load_threshold );
-			return false;
-		}
-
-		bool has_new_contact = false;
-		for ( size_t idx = 0; idx < model.GetLegCount(); ++idx )
-		{
-			bool contact = model.GetLeg( idx ).GetLoad() >= load_threshold;
-			has_new_contact |= contact && !m_PrevContactState[idx];
-			m_PrevContactState[idx] = contact;
-		}
-
-		return has_new_contact;
-	}
 }
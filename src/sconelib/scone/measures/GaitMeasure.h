@@ -91,15 +91,24 @@ namespace scone
 		struct Step {
 			TimeInSeconds time;
 			Real length;
+			TimeInSeconds duration;
 		};
-		std::vector< Step > steps_;
-		std::vector< bool > m_PrevContactState;
+
+		// step statistics are updated incrementally, only the initial steps are kept
+		size_t m_StepCount;
+		Step m_LastStep;
+		std::vector< Step > m_InitialSteps; // first 2 * initiation_steps steps, reserved at construction
+		double m_StepMeasure; // running sums of steps after initiation_steps
+		double m_StepLength;
+		double m_StepTime;
+
+		index_t m_ContactDetector;
 		Real m_PrevGaitDist;
 		PropNode m_Report;
 
 		Real GetNormalizedVelocity( Real p );
+		Real GetStepNormalizedVelocity( const Step& s );
 		Real GetGaitDist( const Model& model );
-		Real GetStepDuration( index_t step ) const;
-		bool HasNewFootContact( const Model& model );
+		size_t GetInitiationSteps() const { return size_t( std::max( 0, initiation_steps ) ); }
 	};
 }
@@ -58,6 +58,14 @@ namespace scone
 			p->Reset();
 	}
 
+	SimulationStage JointMeasure::GetRequiredStage() const
+	{
+		// joint reaction forces are computed from the accelerations
+		if ( !joint_force.IsNull() )
+			return SimulationStage::Acceleration;
+		else return Measure::GetRequiredStage();
+	}
+
 	UpdateResult JointMeasure::UpdateMeasure( const Model& model, double timestamp )
 	{
 		if ( !joint_force.IsNull() )
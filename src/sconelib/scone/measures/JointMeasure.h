@@ -31,6 +31,7 @@ namespace scone
 		virtual double ComputeResult( const Model& model ) override;
 		virtual double GetCurrentResult( const Model& model ) override;
 		virtual void Reset( Model& model ) override;
+		virtual SimulationStage GetRequiredStage() const override;
 
 		/// Joint to which to apply the penalty to.
 		Joint& joint;
@@ -8,6 +8,7 @@
 
 #include "StepMeasure.h"
 #include "scone/model/Model.h"
+#include "scone/model/GaitTracker.h"
 #include "scone/core/Log.h"
 #include "scone/core/Exception.h"
 #include "scone/core/profiler_config.h"
@@ -30,39 +31,38 @@ namespace scone
 		SCONE_THROW_IF( initiation_cycles < 1, "initiation_cycles should be >= 1" );
 		SCONE_THROW_IF( stride_length.IsNull() && stride_duration.IsNull() && stride_velocity.IsNull(),
 			"Any of stride_length / stride_duration / stride_velocity should be defined" );
+
+		// gait cycles are extracted while simulating, only the current cycle is kept in memory
+		std::vector<String> labels;
+		for ( const auto& leg : model.GetLegs() )
+			for ( const char* postfix : { ".grf_norm_x", ".grf_norm_y", ".grf_norm_z", ".cop_x", ".cop_y", ".cop_z" } )
+				labels.push_back( leg.GetName() + postfix );
+		frame_values_.resize( labels.size() );
+		extractor_ = std::make_unique<GaitCycleExtractor>( labels, GaitCycleExtractionSettings{ load_threshold, min_stance_duration_threshold } );
 	}
 
 	UpdateResult StepMeasure::UpdateMeasure( const Model& model, double timestamp )
 	{
 		SCONE_PROFILE_FUNCTION( model.GetProfiler() );
-		
-		// reserve space for better performance
-		if ( stored_data_.IsEmpty() ) {
-			size_t s = size_t( 0.5 + model.GetSimulationEndTime() / model.fixed_measure_step_size );
-			stored_data_.Reserve( s );
-			for ( const auto& leg : model.GetLegs() ) {
-				stored_data_.AddChannels( leg.GetName() + ".grf_norm", { "_x", "_y", "_z" } );
-				stored_data_.AddChannels( leg.GetName() + ".cop", { "_x", "_y", "_z" } );
-			}
-		}
 
-		auto& frame = stored_data_.AddFrame( timestamp );
+		auto& gait_tracker = model.GetGaitTracker();
+		gait_tracker.Update( model );
 		for ( index_t idx = 0; idx < model.GetLegCount(); ++idx )
 		{
-			const auto& leg = model.GetLeg( idx );
-			auto fv = leg.GetContactForceValue();
+			const auto& fv = gait_tracker.GetLegForceValue( idx );
 			Vec3 grf = fv.force / model.GetBW();
-			frame.SetVec3( idx * 6, grf );
-			frame.SetVec3( idx * 6 + 3, fv.point );
+			auto* v = &frame_values_[idx * 6];
+			v[0] = grf.x; v[1] = grf.y; v[2] = grf.z;
+			v[3] = fv.point.x; v[4] = fv.point.y; v[5] = fv.point.z;
 		}
+		extractor_->AddFrame( timestamp, frame_values_.data() );
 
 		return false;
 	}
 
 	double StepMeasure::ComputeResult( const Model& model )
 	{
-		GaitCycleExtractionSettings cfg{ load_threshold, min_stance_duration_threshold };
-		auto cycles = ExtractGaitCycles( stored_data_, cfg );
+		auto cycles = extractor_->GetCycles();
 
 		// calculate stride length / duration / velocity
 		for ( index_t idx = initiation_cycles; idx < cycles.size(); ++idx )
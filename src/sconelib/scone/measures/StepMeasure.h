@@ -9,6 +9,7 @@
 #pragma once
 #include "Measure.h"
 #include "RangePenalty.h"
+#include "scone/core/GaitCycle.h"
 
 namespace scone
 {
@@ -53,6 +54,7 @@ namespace scone
 		virtual String GetClassSignature() const override;
 
 	private:
-		Storage<Real> stored_data_;
+		u_ptr<GaitCycleExtractor> extractor_;
+		std::vector<Real> frame_values_;
 	};
 }
@@ -45,6 +45,14 @@ namespace scone
 		UpdateSensorBufferValues();
 	}
 
+	size_t DelayedSensorGroup::GetMemorySize() const
+	{
+		size_t size = 0;
+		for ( const auto& s : sensors_ )
+			size += s.second.delay() * sizeof( Real );
+		return size;
+	}
+
 	DelayedActuatorValue DelayedActuatorGroup::GetDelayedActuatorValue( Actuator& actuator, TimeInSeconds delay, TimeInSeconds step_size )
 	{
 		auto delay_size = GetDelaySampleSize( delay, step_size );
@@ -85,4 +93,12 @@ namespace scone
 		for ( auto& b : buffers_ )
 			b.second.reset();
 	}
+
+	size_t DelayedActuatorGroup::GetMemorySize() const
+	{
+		size_t size = 0;
+		for ( const auto& a : actuators_ )
+			size += a.second.delay() * sizeof( Real );
+		return size;
+	}
 }
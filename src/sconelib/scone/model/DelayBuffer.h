@@ -37,6 +37,7 @@ namespace scone
 		void AdvanceSensorBuffers();
 		void UpdateSensorBufferValues();
 		void Reset();
+		size_t GetMemorySize() const;
 
 		std::map< size_t, DelayBuffer > buffers_;
 		std::vector< std::pair<Sensor*, DelayBufferChannel> > sensors_; // #perf: use flat_map instead?
@@ -48,6 +49,7 @@ namespace scone
 		void AdvanceActuatorBuffers();
 		void ClearActuatorBufferValues();
 		void Reset();
+		size_t GetMemorySize() const;
 
 		std::map< size_t, DelayBuffer > buffers_;
 		std::vector< std::pair<Actuator*, DelayBufferChannel> > actuators_;
@@ -0,0 +1,73 @@
+/*
+** GaitTracker.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "GaitTracker.h"
+#include "Model.h"
+#include "Leg.h"
+#include "scone/core/Exception.h"
+
+namespace scone
+{
+	GaitTracker::GaitTracker( const Model& model ) :
+		time_( NoTime ),
+		step_( -1 ),
+		leg_loads_( model.GetLegCount(), 0.0 ),
+		leg_force_values_( model.GetLegCount() )
+	{
+		SCONE_ERROR_IF( model.GetLegCount() > 32, "GaitTracker supports a maximum of 32 legs" );
+	}
+
+	index_t GaitTracker::AddContactDetector( Real load_threshold )
+	{
+		detectors_.emplace_back( ContactDetector{ load_threshold } );
+		return detectors_.size() - 1;
+	}
+
+	void GaitTracker::Update( const Model& model )
+	{
+		if ( model.GetIntegrationStep() == step_ && model.GetTime() == time_ )
+			return; // already up-to-date
+
+		for ( index_t idx = 0; idx < leg_loads_.size(); ++idx ) {
+			const auto& leg = model.GetLeg( idx );
+			leg_loads_[idx] = leg.GetLoad();
+			leg_force_values_[idx] = leg.GetContactForceValue();
+		}
+		step_ = model.GetIntegrationStep();
+		time_ = model.GetTime();
+	}
+
+	bool GaitTracker::UpdateContactDetector( const Model& model, index_t detector )
+	{
+		Update( model );
+		auto& cd = detectors_[detector];
+		if ( cd.time_ == time_ )
+			return cd.new_contact_mask_ != 0; // already updated for this step
+
+		xo::uint32 contact_mask = 0;
+		for ( index_t idx = 0; idx < leg_loads_.size(); ++idx )
+			if ( leg_loads_[idx] >= cd.load_threshold_ )
+				contact_mask |= 1u << idx;
+
+		// first update only initializes the contact state
+		cd.new_contact_mask_ = cd.initialized_ ? contact_mask & ~cd.contact_mask_ : 0;
+		cd.contact_mask_ = contact_mask;
+		cd.initialized_ = true;
+		cd.time_ = time_;
+
+		return cd.new_contact_mask_ != 0;
+	}
+
+	void GaitTracker::Reset()
+	{
+		time_ = NoTime;
+		step_ = -1;
+		for ( auto& cd : detectors_ )
+			cd = ContactDetector{ cd.load_threshold_ };
+	}
+}
@@ -0,0 +1,60 @@
+/*
+** GaitTracker.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include "ForceAtPoint.h"
+#include <vector>
+
+namespace scone
+{
+	/// Per-step leg load and contact state, shared by gait measures and controllers.
+	/// Leg loads and contact forces are computed once per integration step; each consumer
+	/// adds its own contact detector to detect new foot contacts for a specific load threshold.
+	class SCONE_API GaitTracker
+	{
+	public:
+		GaitTracker( const Model& model );
+
+		// add a contact detector for a specific load threshold [BW], returns detector index
+		index_t AddContactDetector( Real load_threshold );
+
+		// update leg loads and contact forces, does nothing if already updated for the current step
+		void Update( const Model& model );
+
+		// update leg values and the contact state of a detector, returns true if any leg has a new contact
+		bool UpdateContactDetector( const Model& model, index_t detector );
+
+		size_t GetLegCount() const { return leg_loads_.size(); }
+		Real GetLegLoad( index_t leg ) const { return leg_loads_[leg]; }
+		const ForceAtPoint& GetLegForceValue( index_t leg ) const { return leg_force_values_[leg]; }
+		bool HasContact( index_t detector, index_t leg ) const { return detectors_[detector].contact_mask_ & ( 1u << leg ); }
+		bool HasNewContact( index_t detector, index_t leg ) const { return detectors_[detector].new_contact_mask_ & ( 1u << leg ); }
+		bool HasNewContact( index_t detector ) const { return detectors_[detector].new_contact_mask_ != 0; }
+
+		// reset all detectors and cached values
+		void Reset();
+
+	private:
+		struct ContactDetector {
+			Real load_threshold_;
+			xo::uint32 contact_mask_ = 0;
+			xo::uint32 new_contact_mask_ = 0;
+			bool initialized_ = false;
+			TimeInSeconds time_ = NoTime;
+		};
+
+		TimeInSeconds time_;
+		int step_;
+		std::vector< Real > leg_loads_;
+		std::vector< ForceAtPoint > leg_force_values_;
+		std::vector< ContactDetector > detectors_;
+	};
+}
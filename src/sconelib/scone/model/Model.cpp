@@ -16,6 +16,7 @@
 #include "SensorDelayAdapter.h"
 #include "State.h"
 #include "MuscleId.h"
+#include "GaitTracker.h"
 #include "scone/controllers/CompositeController.h"
 #include "scone/core/Factories.h"
 #include "scone/core/Log.h"
@@ -34,6 +35,7 @@
 #include "xo/container/container_algorithms.h"
 
 #include <algorithm>
+#include <atomic>
 #include <tuple>
 #include <fstream>
 #include "symmetry_tools.h"
@@ -75,6 +77,10 @@ namespace scone
 		m_PrevStoreDataTime( 0 ),
 		m_PrevStoreDataStep( 0 ),
 		m_SimulationTimer( false ),
+		m_ControllerTimer( false ),
+		m_MeasureTimer( false ),
+		m_StorageTimer( false ),
+		m_AllocationCount( 0 ),
 		m_StoreData( false ),
 		m_StoreDataProfiles{ {
 			{ 1.0 / GetSconeSetting<double>( "data.frequency" ), { StoreDataTypes::State }, GetSconeSetting<String>( "data.format" ) },
@@ -113,9 +119,17 @@ namespace scone
 		INIT_PROP( props, fixed_control_step_size, 0.001 );
 		INIT_PROP( props, fixed_measure_step_size, fixed_control_step_size );
 		INIT_PROP( props, max_integration_step_size, scone_version >= version( 2, 0, 0 ) ? fixed_control_step_size : 0.001 );
-		fixed_step_size = std::min( fixed_control_step_size, fixed_measure_step_size );
+		INIT_PROP( props, use_multi_rate_stepping, false );
+		if ( !use_multi_rate_stepping && fixed_measure_step_size < fixed_control_step_size )
+			log::warning( "fixed_measure_step_size is smaller than fixed_control_step_size, measures are updated at fixed_control_step_size unless use_multi_rate_stepping = 1" );
+		fixed_step_size = use_multi_rate_stepping ? std::min( fixed_control_step_size, fixed_measure_step_size ) : fixed_control_step_size;
 		fixed_control_step_interval = static_cast<int>( std::round( fixed_control_step_size / fixed_step_size ) );
-		fixed_analysis_step_interval = static_cast<int>( std::round( fixed_measure_step_size / fixed_step_size ) );
+		fixed_analysis_step_interval = std::max( 1, static_cast<int>( std::round( fixed_measure_step_size / fixed_step_size ) ) );
+		auto is_multiple = [&]( double step_size, int interval ) { return std::abs( interval * fixed_step_size - step_size ) <= 1e-9 * step_size; };
+		if ( !is_multiple( fixed_control_step_size, fixed_control_step_interval ) )
+			log::warning( "fixed_control_step_size is not a multiple of fixed_measure_step_size, controls are updated every ", fixed_control_step_interval * fixed_step_size, "s" );
+		if ( fixed_measure_step_size > fixed_step_size && !is_multiple( fixed_measure_step_size, fixed_analysis_step_interval ) )
+			log::warning( "fixed_measure_step_size is not a multiple of the integration step size, measures are updated every ", fixed_analysis_step_interval * fixed_step_size, "s" );
 
 		// set default store data profile from settings
 		for ( index_t idx = 0; idx < 2; ++idx ) {
@@ -148,6 +162,19 @@ namespace scone
 	const Spring& Model::FindSpring( const String& name ) const { return *FindByName( m_SpringPtrs, name ); }
 	const Actuator& Model::FindActuator( const String& name ) const { return *FindByName( m_ActuatorPtrs, name ); }
 
+	index_t AllocateModelSlotIndex()
+	{
+		static std::atomic<index_t> next_index = 0;
+		return next_index++;
+	}
+
+	GaitTracker& Model::GetGaitTracker() const
+	{
+		if ( !m_GaitTracker )
+			m_GaitTracker = std::make_unique<GaitTracker>( *this );
+		return *m_GaitTracker;
+	}
+
 	Muscle& Model::FindMuscleOrGroup( const String& name )
 	{
 		if ( auto musit = TryFindByName( GetMuscles(), name ); musit != GetMuscles().end() )
@@ -433,6 +460,7 @@ namespace scone
 	void Model::StoreCurrentFrame()
 	{
 		SCONE_PROFILE_FUNCTION( GetProfiler() );
+		auto st = xo::scoped_timer_starter( m_StorageTimer );
 		if ( m_Data.IsEmpty() || GetTime() > m_Data.Back().GetTime() )
 			m_Data.AddFrame( GetTime() );
 		StoreData( m_Data.Back(), GetStoreDataFlags() );
@@ -473,8 +501,10 @@ namespace scone
 		}
 
 		bool terminate = false;
-		if ( auto* c = GetController() )
+		if ( auto* c = GetController() ) {
+			auto st = xo::scoped_timer_starter( m_ControllerTimer );
 			terminate |= c->UpdateControls( *this, GetTime() );
+		}
 
 		if ( GetTime() > 0 )
 		{
@@ -493,15 +523,29 @@ namespace scone
 		SCONE_PROFILE_FUNCTION( GetProfiler() );
 
 		UpdateResult result;
-		if ( auto* c = GetController() )
+		if ( auto* c = GetController() ) {
+			auto st = xo::scoped_timer_starter( m_ControllerTimer );
 			result |= c->UpdateAnalysis( *this, GetTime() );
-		if ( auto* m = GetMeasure() )
+		}
+		if ( auto* m = GetMeasure() ) {
+			auto st = xo::scoped_timer_starter( m_MeasureTimer );
 			result |= m->UpdateAnalysis( *this, GetTime() );
+		}
 
 		if ( result.must_terminate_ )
 			RequestTermination( result.termination_reason_ );
 	}
 
+	SimulationStage Model::GetRequiredStage() const
+	{
+		auto stage = SimulationStage::Dynamics;
+		if ( auto* c = GetController() )
+			stage = std::max( stage, c->GetRequiredStage() );
+		if ( auto* m = GetMeasure() )
+			stage = std::max( stage, m->GetRequiredStage() );
+		return stage;
+	}
+
 	std::vector< ForceAtPoint > Model::GetContactForceValues() const
 	{
 		std::vector< ForceAtPoint > fvec;
@@ -510,7 +554,7 @@ namespace scone
 		{
 			auto cfv = cf->GetForceValue();
 			if ( xo::squared_length( cfv.force ) > REAL_WIDE_EPSILON )
-				fvec.push_back( cf->GetForceValue() );
+				fvec.push_back( cfv );
 		}
 		return fvec;
 	}
@@ -561,12 +605,42 @@ namespace scone
 		m_PrevStoreDataStep = 0;
 		m_DelayedSensors.Reset();
 		m_DelayedActuators.Reset();
+		m_Slots.clear();
+		InvalidateRayCaster();
+		m_ControllerTimer = xo::timer( false );
+		m_MeasureTimer = xo::timer( false );
+		m_StorageTimer = xo::timer( false );
+		m_AllocationCount = 0;
+		if ( m_GaitTracker )
+			m_GaitTracker->Reset();
 		if ( GetController() )
 			GetController()->Reset( *this );
 		if ( GetMeasure() )
 			GetMeasure()->Reset( *this );
 	}
 
+	void Model::Reparameterize( Params& par, const FactoryProps& controller_fp, const FactoryProps& measure_fp )
+	{
+		SCONE_PROFILE_FUNCTION( GetProfiler() );
+
+		// remove the components that are re-created, so that Reset() does not update them
+		if ( controller_fp )
+			m_Controller.reset();
+		if ( measure_fp )
+			m_Measure.reset();
+
+		// reset to initial state, existing buffers and storage are reused
+		Reset();
+		m_TerminationReason.clear();
+		m_CustomValues.clear();
+
+		// create new controller and measure in the same order as ModelObjective::CreateModelFromParams()
+		if ( controller_fp )
+			CreateController( controller_fp, par );
+		if ( measure_fp )
+			CreateMeasure( measure_fp, par );
+	}
+
 	void Model::TryAdvanceSimulationTo( double time )
 	{
 		try
@@ -589,9 +663,25 @@ namespace scone
 		perf_pn["simulation_frequency"] = ( GetIntegrationStep() / GetTime() );
 		if ( auto sd = GetSimulationDuration(); sd > 0 )
 			perf_pn["simulation_duration"] = xo::stringf( "%.3fs (%.4gx real-time)", sd, GetTime() / sd );
+		pn.add_child( "Performance Counters", GetPerfCounters().ToPropNode() );
 		return pn;
 	}
 
+	PerfCounters Model::GetPerfCounters() const
+	{
+		PerfCounters pc;
+		pc.simulations = 1;
+		pc.integration_steps = std::max( GetIntegrationStep(), 0 );
+		pc.controller_time = m_ControllerTimer().secondsd();
+		pc.measure_time = m_MeasureTimer().secondsd();
+		pc.storage_time = m_StorageTimer().secondsd();
+		pc.allocations = m_AllocationCount;
+		pc.arena_memory = m_Arena ? m_Arena->GetMemorySize() : 0;
+		pc.delay_buffer_memory = m_DelayedSensors.GetMemorySize() + m_DelayedActuators.GetMemorySize()
+			+ m_SensorDelayStorage.GetFrameCount() * m_SensorDelayStorage.GetChannelCount() * sizeof( Real );
+		return pc;
+	}
+
 	std::vector<path> Model::WriteResults( const path& file ) const
 	{
 		std::vector<path> files;
@@ -669,6 +759,24 @@ namespace scone
 		else return nullptr;
 	}
 
+	RayCaster& Model::UpdRayCaster() const
+	{
+		if ( !m_RayCaster )
+			m_RayCaster = std::make_unique<RayCaster>( *this );
+		m_RayCaster->Update();
+		return *m_RayCaster;
+	}
+
+	std::pair<Real, ContactGeometry*> Model::GetRayIntersection( const Vec3& pos, const Vec3& dir, Real max_dist, const Body* ignore_body ) const
+	{
+		return UpdRayCaster().Cast( pos, dir, max_dist, ignore_body );
+	}
+
+	void Model::GetRayDistances( const Vec3* pos, const Vec3* dir, size_t n, Real max_dist, Real* dist ) const
+	{
+		UpdRayCaster().Cast( pos, dir, n, max_dist, dist );
+	}
+
 	Vec3 Model::GetProjectedOntoGround( const Vec3& point, const Vec3& up ) const
 	{
 		if ( auto* ground = GetGroundPlane() )
@@ -866,6 +974,7 @@ namespace scone
 
 		m_Controller.reset();
 		m_Measure.reset();
+		m_GaitTracker.reset();
 		m_Sensors.clear();
 		m_SensorDelayAdapters.clear();
 
@@ -873,6 +982,7 @@ namespace scone
 		m_SensorDelayStorage.Clear();
 		m_Data.Clear();
 		m_UserData.clear();
+		m_Slots.clear();
 		m_PrevStoreDataTime = 0;
 		m_PrevStoreDataStep = 0;
 	}
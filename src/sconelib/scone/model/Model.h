@@ -24,11 +24,15 @@
 #include "Spring.h"
 #include "MuscleGroup.h"
 #include "MuscleActivationSettings.h"
+#include "ModelSlot.h"
+#include "RayCaster.h"
+#include "PerfCounters.h"
 
 #include "scone/controllers/Controller.h"
 #include "scone/core/ExternalResourceContainer.h"
 #include "scone/core/HasName.h"
 #include "scone/core/HasSignature.h"
+#include "scone/core/ModelArena.h"
 #include "scone/core/Storage.h"
 #include "scone/measures/Measure.h"
 #include "scone/core/Factories.h"
@@ -92,7 +96,12 @@ namespace scone
 
 		// Contact geometries
 		const std::vector< ContactGeometryUP >& GetContactGeometries() const { return m_ContactGeometries; }
-		virtual std::pair<Real, ContactGeometry*> GetRayIntersection( const Vec3& pos, const Vec3& dir, Real max_dist ) const { return { max_dist, nullptr }; }
+		/// Get the distance and geometry of the nearest contact geometry along a ray, ignoring geometries attached to ignore_body.
+		virtual std::pair<Real, ContactGeometry*> GetRayIntersection( const Vec3& pos, const Vec3& dir, Real max_dist, const Body* ignore_body = nullptr ) const;
+		/// Get the distance to the nearest contact geometry for n rays, or max_dist if nothing is hit.
+		virtual void GetRayDistances( const Vec3* pos, const Vec3* dir, size_t n, Real max_dist, Real* dist ) const;
+		/// Must be called when body positions change without advancing the simulation time, e.g. when setting the state.
+		void InvalidateRayCaster() const { if ( m_RayCaster ) m_RayCaster->Invalidate(); }
 
 		// Contact forces
 		const std::vector< ContactForceUP >& GetContactForces() const { return m_ContactForces; }
@@ -120,6 +129,9 @@ namespace scone
 		Real GetMeasureResult() { return GetMeasure() ? GetMeasure()->GetWeightedResult( *this ) : 0; }
 		Real GetCurrentMeasureResult() { return GetMeasure() ? GetMeasure()->GetCurrentWeightedResult( *this ) : 0; }
 
+		// Highest stage of the model state accessed by the controller and measure during updates
+		SimulationStage GetRequiredStage() const;
+
 		// Model interaction
 		virtual Spring* GetInteractionSpring() { return nullptr; }
 		virtual const Spring* GetInteractionSpring() const { return nullptr; }
@@ -131,6 +143,9 @@ namespace scone
 		std::vector< Leg >& GetLegs() { return m_Legs; }
 		const std::vector< Leg >& GetLegs() const { return m_Legs; }
 
+		// shared per-step leg contact state, created on first access
+		GaitTracker& GetGaitTracker() const;
+
 		// Get simulation info
 		virtual TimeInSeconds GetTime() const = 0;
 		virtual int GetIntegrationStep() const = 0;
@@ -152,6 +167,14 @@ namespace scone
 		// Reset the model and controllers to the initial state
 		virtual void Reset();
 
+		// Reset the model and replace the controller and / or measure with new instances created from par
+		// Only controllers and measures created via CreateController() / CreateMeasure() can be replaced
+		void Reparameterize( Params& par, const FactoryProps& controller_fp, const FactoryProps& measure_fp );
+
+		// Take ownership of the arena that contains (part of) the components of this model, see ModelArena.h
+		void SetArena( std::unique_ptr< ModelArena > arena ) { SCONE_ASSERT( !m_Arena ); m_Arena = std::move( arena ); }
+		const ModelArena* GetArena() const { return m_Arena.get(); }
+
 		// Simulate model
 		virtual void AdvanceSimulationTo( double time, size_t max_steps = no_size ) = 0;
 		virtual void TryAdvanceSimulationTo( double time );
@@ -166,6 +189,7 @@ namespace scone
 		virtual TimeInSeconds GetSimulationDuration() const { return m_SimulationTimer().secondsd(); }
 		virtual void UpdatePerformanceStats( const path& filename ) const {}
 		virtual std::vector<std::pair<String, std::pair<xo::time, size_t>>> GetBenchmarks() const { return {}; }
+		virtual PerfCounters GetPerfCounters() const;
 
 		// Model data
 		virtual const Storage<Real, TimeInSeconds>& GetData() const { return m_Data; }
@@ -202,6 +226,22 @@ namespace scone
 		PropNode& GetUserData() { return m_UserData; }
 		const std::any& GetUserAnyData( const String& id ) const { return m_UserAnyData.at( id ); }
 		std::any& GetUserAnyData( const String& id ) { return m_UserAnyData[id]; }
+
+		// per-evaluation scratch data, see ModelSlot
+		template< typename T > T& GetSlot( const ModelSlot<T>& slot ) {
+			if ( slot.index() >= m_Slots.size() )
+				m_Slots.resize( slot.index() + 1 );
+			auto& data = m_Slots[slot.index()];
+			if ( !data )
+				data = std::make_unique<ModelSlotValue<T>>();
+			return static_cast<ModelSlotValue<T>&>( *data ).value;
+		}
+		template< typename T > const T* TryGetSlot( const ModelSlot<T>& slot ) const {
+			if ( slot.index() < m_Slots.size() && m_Slots[slot.index()] )
+				return &static_cast<const ModelSlotValue<T>&>( *m_Slots[slot.index()] ).value;
+			else return nullptr;
+		}
+		template< typename T > bool HasSlot( const ModelSlot<T>& slot ) const { return TryGetSlot( slot ) != nullptr; }
 		const Real& GetCustomValue( const String& id ) const { return m_CustomValues.at( id ); }
 		void SetCustomValue( const String& id, Real value ) { m_CustomValues[id] = value; }
 		bool HasCustomValue( const String& id ) const { return m_CustomValues.contains( id ); }
@@ -282,9 +322,14 @@ namespace scone
 		/// Step size used for controllers; default = 0.001.
 		double fixed_control_step_size;
 
-		/// Step size used for measures (not supported by all model types); default = ''fixed_control_step_size''.
+		/// Step size used for measures, should be a multiple of fixed_control_step_size (not supported by all model types).
+		/// Larger values skip analysis updates in between control steps, Statistic integrates the samples over time; default = ''fixed_control_step_size''.
 		double fixed_measure_step_size;
 
+		/// Integrate at the smallest of fixed_control_step_size and fixed_measure_step_size, so that measures can be updated
+		/// in between control steps; otherwise integration is always at fixed_control_step_size; default = 0.
+		bool use_multi_rate_stepping;
+
 		/// Maximum integration step size; default = fixed_control_step_size.
 		double max_integration_step_size;
 
@@ -369,6 +414,7 @@ namespace scone
 		void UpdateSensorDelayAdapters();
 		void UpdateControlValues();
 		void UpdateAnalyses();
+		RayCaster& UpdRayCaster() const;
 
 		void CreateControllers( const PropNode& pn, Params& par );
 		virtual void SetController( ControllerUP c ) { SCONE_ASSERT( !m_Controller ); m_Controller = std::move( c ); }
@@ -387,6 +433,9 @@ namespace scone
 
 		mutable xo::profiler m_Profiler;
 
+		// must be destroyed after all components it contains, so it's declared first
+		std::unique_ptr< ModelArena > m_Arena;
+
 		// model components
 		std::vector< BodyUP > m_Bodies;
 		std::vector< JointUP > m_Joints;
@@ -395,6 +444,7 @@ namespace scone
 		std::vector< LigamentUP > m_Ligaments;
 		std::vector< SpringUP > m_Springs;
 		std::vector< Leg > m_Legs;
+		mutable GaitTrackerUP m_GaitTracker;
 		std::vector< ContactGeometryUP > m_ContactGeometries;
 		std::vector< ContactForceUP > m_ContactForces;
 
@@ -427,10 +477,16 @@ namespace scone
 		Storage< Real, TimeInSeconds > m_Data;
 		PropNode m_UserData;
 		std::map<String, std::any> m_UserAnyData; // must be map for persistence
+		std::vector< std::unique_ptr< ModelSlotData > > m_Slots;
+		mutable std::unique_ptr< RayCaster > m_RayCaster;
 		xo::flat_map<String, Real> m_CustomValues;
 		TimeInSeconds m_PrevStoreDataTime;
 		int m_PrevStoreDataStep;
 		xo::timer m_SimulationTimer;
+		xo::timer m_ControllerTimer;
+		xo::timer m_MeasureTimer;
+		xo::timer m_StorageTimer;
+		size_t m_AllocationCount; // heap allocations during AdvanceSimulationTo(), see AllocationTracker.h
 		std::vector< Real > m_InitialStateValues;
 
 		// model properties
@@ -439,10 +495,12 @@ namespace scone
 		PropNode m_ModelInfo;
 		mutable ExternalResourceContainer m_ExternalResources;
 
-		// simulation settings
-		double fixed_step_size;
-		int fixed_control_step_interval;
-		int fixed_analysis_step_interval;
+		// simulation settings, for use by model implementations
+		// CAUTION: fixed_step_size used to be the smallest of fixed_control_step_size and fixed_measure_step_size;
+		// it now equals fixed_control_step_size unless use_multi_rate_stepping is set
+		double fixed_step_size; // integration step size
+		int fixed_control_step_interval; // number of fixed_step_size steps between control updates, 1 unless use_multi_rate_stepping
+		int fixed_analysis_step_interval; // number of fixed_step_size steps between analysis updates, at least 1
 		bool m_StoreData;
 		std::array<StoreDataProfile, 2> m_StoreDataProfiles;
 		index_t m_StoreDataProfileIdx;
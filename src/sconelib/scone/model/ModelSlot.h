@@ -0,0 +1,47 @@
+/*
+** ModelSlot.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+
+namespace scone
+{
+	/// Base class for per-model scratch data, see ModelSlot.
+	struct ModelSlotData
+	{
+		virtual ~ModelSlotData() = default;
+	};
+
+	/// Storage for per-model scratch data of type T.
+	template< typename T > struct ModelSlotValue : public ModelSlotData
+	{
+		T value{};
+	};
+
+	/// Returns a new unique slot index, used once for each ModelSlot type.
+	SCONE_API index_t AllocateModelSlotIndex();
+
+	/// Typed handle to per-model scratch data, used by objectives and controllers
+	/// to keep state during a single evaluation. Create the handle once (e.g. at construction)
+	/// and access the data through Model::GetSlot(). Slot data is default-constructed on first access
+	/// and destroyed by Model::Reset().
+	/// All handles of type T refer to the same slot, so T should be a type that is specific to its user.
+	template< typename T > class ModelSlot
+	{
+	public:
+		using value_type = T;
+		ModelSlot() : index_( TypeIndex() ) {}
+		index_t index() const { return index_; }
+
+	private:
+		static index_t TypeIndex() { static const index_t idx = AllocateModelSlotIndex(); return idx; }
+		index_t index_;
+	};
+}
@@ -0,0 +1,64 @@
+/*
+** PerfCounters.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#include "PerfCounters.h"
+
+#include <algorithm>
+
+namespace scone
+{
+	PerfCounters& PerfCounters::operator+=( const PerfCounters& other )
+	{
+		simulations += other.simulations;
+		cached_evaluations += other.cached_evaluations;
+		integration_steps += other.integration_steps;
+		rejected_steps += other.rejected_steps;
+		for ( size_t i = 0; i < realize_calls.size(); ++i )
+			realize_calls[i] += other.realize_calls[i];
+		controller_time += other.controller_time;
+		measure_time += other.measure_time;
+		storage_time += other.storage_time;
+		delay_buffer_memory += other.delay_buffer_memory;
+		arena_memory += other.arena_memory;
+		allocations += other.allocations;
+		return *this;
+	}
+
+	std::vector< std::pair< String, double > > PerfCounters::GetValues() const
+	{
+		// totals are divided by the number of simulations, so that aggregated counters remain comparable
+		const double n = std::max<size_t>( simulations, 1 );
+		const double steps = std::max<size_t>( integration_steps, 1 );
+		return {
+			{ "simulations", double( simulations ) },
+			{ "cached_evaluations", double( cached_evaluations ) },
+			{ "integration_steps", integration_steps / n },
+			{ "rejected_steps", rejected_steps / n },
+			{ "realize_position", RealizeCalls( SimulationStage::Position ) / n },
+			{ "realize_velocity", RealizeCalls( SimulationStage::Velocity ) / n },
+			{ "realize_dynamics", RealizeCalls( SimulationStage::Dynamics ) / n },
+			{ "realize_acceleration", RealizeCalls( SimulationStage::Acceleration ) / n },
+			{ "controller_time", controller_time / n },
+			{ "measure_time", measure_time / n },
+			{ "storage_time", storage_time / n },
+			{ "controller_time_per_step", controller_time / steps },
+			{ "measure_time_per_step", measure_time / steps },
+			{ "delay_buffer_memory", delay_buffer_memory / n },
+			{ "arena_memory", arena_memory / n },
+			{ "allocations_per_step", allocations / steps }
+		};
+	}
+
+	PropNode PerfCounters::ToPropNode() const
+	{
+		PropNode pn;
+		for ( const auto& [name, value] : GetValues() )
+			pn.set( name, value );
+		return pn;
+	}
+}
@@ -0,0 +1,46 @@
+/*
+** PerfCounters.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include "scone/core/PropNode.h"
+#include "SimulationStage.h"
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace scone
+{
+	/// Performance counters of a Model simulation, reset when the Model is reset.
+	/// Counters can be added to aggregate multiple simulations, e.g. all evaluations of an optimization step.
+	struct SCONE_API PerfCounters
+	{
+		size_t simulations = 0; // number of simulations included in these counters
+		size_t cached_evaluations = 0; // evaluations found in the evaluation cache, which are not included in the other counters
+		size_t integration_steps = 0;
+		size_t rejected_steps = 0; // steps rejected by the integrator error control
+		std::array< size_t, 4 > realize_calls{}; // realizations per SimulationStage, including those of the integrator
+		double controller_time = 0; // [s] wall time spent in Controller updates
+		double measure_time = 0; // [s] wall time spent in Measure updates
+		double storage_time = 0; // [s] wall time spent storing data frames
+		size_t delay_buffer_memory = 0; // [bytes] memory used for neural delay buffers
+		size_t arena_memory = 0; // [bytes] memory used by the ModelArena, if any
+		size_t allocations = 0; // heap allocations during simulation, only counted with SCONE_ALLOCATION_TRACKING
+
+		size_t& RealizeCalls( SimulationStage s ) { return realize_calls[size_t( s )]; }
+		size_t RealizeCalls( SimulationStage s ) const { return realize_calls[size_t( s )]; }
+
+		PerfCounters& operator+=( const PerfCounters& other );
+
+		/// Counter names and values, times and memory are per simulation
+		std::vector< std::pair< String, double > > GetValues() const;
+		PropNode ToPropNode() const;
+	};
+}
@@ -0,0 +1,298 @@
+/*
+** RayCaster.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#include "RayCaster.h"
+#include "Model.h"
+#include "Body.h"
+#include "ContactGeometry.h"
+#include "xo/shape/shape.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace scone
+{
+	namespace
+	{
+		constexpr Real no_hit = std::numeric_limits<Real>::infinity();
+
+		Real Element( const Vec3& v, index_t i ) { return i == 0 ? v.x : ( i == 1 ? v.y : v.z ); }
+		Vec3 MinElements( const Vec3& a, const Vec3& b ) { return Vec3( std::min( a.x, b.x ), std::min( a.y, b.y ), std::min( a.z, b.z ) ); }
+		Vec3 MaxElements( const Vec3& a, const Vec3& b ) { return Vec3( std::max( a.x, b.x ), std::max( a.y, b.y ), std::max( a.z, b.z ) ); }
+		Vec3 ToVec3( const xo::vec3f& v ) { return Vec3( v.x, v.y, v.z ); }
+
+		// bounding sphere radius of a shape around its origin, or zero if the shape is not supported
+		Real GetBoundingRadius( const xo::shape& s ) {
+			if ( auto* sp = std::get_if<xo::sphere>( &s ) )
+				return sp->radius_;
+			else if ( auto* b = std::get_if<xo::box>( &s ) )
+				return xo::length( ToVec3( b->half_dim_ ) );
+			else if ( auto* c = std::get_if<xo::capsule>( &s ) )
+				return c->radius_ + 0.5 * c->height_;
+			else if ( auto* cy = std::get_if<xo::cylinder>( &s ) )
+				return std::sqrt( xo::squared( Real( cy->radius_ ) ) + xo::squared( 0.5 * cy->height_ ) );
+			else return 0;
+		}
+
+		// nearest t >= 0 where ray hits the side of a cylinder along the y-axis with radius r and half height hh
+		Real IntersectCylinderSide( const Vec3& o, const Vec3& d, Real r, Real hh ) {
+			const auto a = d.x * d.x + d.z * d.z;
+			const auto c = o.x * o.x + o.z * o.z - r * r;
+			if ( c <= 0 && std::abs( o.y ) <= hh )
+				return 0; // origin inside
+			if ( a < REAL_EPSILON )
+				return no_hit;
+			const auto b = o.x * d.x + o.z * d.z;
+			const auto disc = b * b - a * c;
+			if ( disc < 0 )
+				return no_hit;
+			const auto t = ( -b - std::sqrt( disc ) ) / a;
+			return t >= 0 && std::abs( o.y + t * d.y ) <= hh ? t : no_hit;
+		}
+
+		// entry t of ray into axis-aligned box, or no_hit
+		Real IntersectAabb( const Vec3& o, const Vec3& inv_d, const Vec3& lower, const Vec3& upper, Real max_t ) {
+			Real tmin = 0, tmax = max_t;
+			for ( index_t i = 0; i < 3; ++i ) {
+				auto t0 = ( Element( lower, i ) - Element( o, i ) ) * Element( inv_d, i );
+				auto t1 = ( Element( upper, i ) - Element( o, i ) ) * Element( inv_d, i );
+				if ( t0 > t1 ) std::swap( t0, t1 );
+				tmin = std::max( tmin, t0 );
+				tmax = std::min( tmax, t1 );
+			}
+			return tmin <= tmax ? tmin : no_hit;
+		}
+	}
+
+	Real IntersectRaySphere( const Vec3& o, const Vec3& d, Real r )
+	{
+		const auto b = xo::dot_product( o, d );
+		const auto c = xo::dot_product( o, o ) - r * r;
+		if ( c <= 0 )
+			return 0; // origin inside sphere
+		if ( b > 0 )
+			return no_hit;
+		const auto disc = b * b - c;
+		return disc >= 0 ? -b - std::sqrt( disc ) : no_hit;
+	}
+
+	Real IntersectRayBox( const Vec3& o, const Vec3& d, const Vec3& h )
+	{
+		Real tmin = 0, tmax = no_hit;
+		for ( index_t i = 0; i < 3; ++i ) {
+			const auto oi = Element( o, i ), di = Element( d, i ), hi = Element( h, i );
+			if ( std::abs( di ) < REAL_EPSILON ) {
+				if ( oi < -hi || oi > hi )
+					return no_hit;
+			}
+			else {
+				auto t0 = ( -hi - oi ) / di;
+				auto t1 = ( hi - oi ) / di;
+				if ( t0 > t1 ) std::swap( t0, t1 );
+				tmin = std::max( tmin, t0 );
+				tmax = std::min( tmax, t1 );
+				if ( tmin > tmax )
+					return no_hit;
+			}
+		}
+		return tmin;
+	}
+
+	Real IntersectRayCylinder( const Vec3& o, const Vec3& d, Real r, Real hh )
+	{
+		// side, then end caps
+		auto t = IntersectCylinderSide( o, d, r, hh );
+		if ( std::abs( d.y ) >= REAL_EPSILON ) {
+			for ( auto y : { -hh, hh } ) {
+				const auto tc = ( y - o.y ) / d.y;
+				if ( tc >= 0 && tc < t && xo::squared( o.x + tc * d.x ) + xo::squared( o.z + tc * d.z ) <= r * r )
+					t = tc;
+			}
+		}
+		return t;
+	}
+
+	Real IntersectRayCapsule( const Vec3& o, const Vec3& d, Real r, Real hh )
+	{
+		auto t = IntersectCylinderSide( o, d, r, hh );
+		t = std::min( t, IntersectRaySphere( o - Vec3( 0, hh, 0 ), d, r ) );
+		t = std::min( t, IntersectRaySphere( o + Vec3( 0, hh, 0 ), d, r ) );
+		return t;
+	}
+
+	Real IntersectRayPlane( const Vec3& o, const Vec3& d, const Vec3& n )
+	{
+		const auto h = xo::dot_product( n, o );
+		if ( h <= 0 )
+			return 0; // origin behind plane
+		const auto denom = xo::dot_product( n, d );
+		return denom < 0 ? -h / denom : no_hit;
+	}
+
+	RayCaster::RayCaster( const Model& model ) :
+		model_( model ),
+		time_( xo::constantsd::NaN() )
+	{
+		for ( const auto& cg : model.GetContactGeometries() ) {
+			if ( cg->HasFileName() )
+				continue;
+			if ( std::holds_alternative<xo::plane>( cg->GetShape() ) )
+				planes_.push_back( Primitive{ cg.get(), 0 } );
+			else if ( auto r = GetBoundingRadius( cg->GetShape() ); r > 0 )
+				prims_.push_back( Primitive{ cg.get(), r } );
+		}
+	}
+
+	void RayCaster::Update()
+	{
+		const auto t = model_.GetTime();
+		if ( t == time_ )
+			return;
+
+		UpdatePrimitives();
+		if ( nodes_.empty() )
+			Build();
+		else Refit();
+		time_ = t;
+	}
+
+	void RayCaster::UpdatePrimitives()
+	{
+		auto update = []( Primitive& p ) {
+			const auto& cg = *p.geom;
+			const auto& body = cg.GetBody();
+			p.ori = body.GetOrientation() * cg.GetOri();
+			p.pos = body.GetPosOfPointOnBody( cg.GetPos() );
+		};
+		std::for_each( prims_.begin(), prims_.end(), update );
+		std::for_each( planes_.begin(), planes_.end(), update );
+	}
+
+	void RayCaster::Build()
+	{
+		nodes_.clear();
+		if ( !prims_.empty() ) {
+			nodes_.reserve( 2 * prims_.size() - 1 );
+			BuildNode( 0, std::uint32_t( prims_.size() ) );
+			Refit();
+		}
+	}
+
+	std::uint32_t RayCaster::BuildNode( std::uint32_t begin, std::uint32_t end )
+	{
+		const auto idx = std::uint32_t( nodes_.size() );
+		nodes_.push_back( Node{ Vec3::zero(), Vec3::zero(), begin, end - begin } );
+		if ( end - begin > 1 ) {
+			// each leaf holds a single primitive; split at the median along the axis with the largest spread of primitive centers
+			Vec3 lower = prims_[begin].pos, upper = prims_[begin].pos;
+			for ( auto i = begin + 1; i < end; ++i ) {
+				lower = MinElements( lower, prims_[i].pos );
+				upper = MaxElements( upper, prims_[i].pos );
+			}
+			const auto ext = upper - lower;
+			const index_t axis = ext.x > ext.y ? ( ext.x > ext.z ? 0 : 2 ) : ( ext.y > ext.z ? 1 : 2 );
+			const auto mid = begin + ( end - begin ) / 2;
+			std::nth_element( prims_.begin() + begin, prims_.begin() + mid, prims_.begin() + end,
+				[axis]( const Primitive& a, const Primitive& b ) { return Element( a.pos, axis ) < Element( b.pos, axis ); } );
+			BuildNode( begin, mid );
+			const auto right = BuildNode( mid, end );
+			nodes_[idx].first = right;
+			nodes_[idx].count = 0;
+		}
+		return idx;
+	}
+
+	void RayCaster::Refit()
+	{
+		// children always come after their parent, so a reverse sweep updates bottom-up
+		for ( auto i = nodes_.size(); i-- > 0; ) {
+			auto& n = nodes_[i];
+			if ( n.count > 0 ) {
+				const auto& p = prims_[n.first];
+				const Vec3 r( p.radius, p.radius, p.radius );
+				n.lower = p.pos - r;
+				n.upper = p.pos + r;
+			}
+			else {
+				const auto& l = nodes_[i + 1];
+				const auto& r = nodes_[n.first];
+				n.lower = MinElements( l.lower, r.lower );
+				n.upper = MaxElements( l.upper, r.upper );
+			}
+		}
+	}
+
+	Real RayCaster::Intersect( const Primitive& p, const Vec3& pos, const Vec3& dir, Real max_dist ) const
+	{
+		const auto inv_ori = xo::conjugate( p.ori );
+		const auto o = inv_ori * ( pos - p.pos );
+		const auto d = inv_ori * dir;
+		const auto& s = p.geom->GetShape();
+		Real t = no_hit;
+		if ( auto* sp = std::get_if<xo::sphere>( &s ) )
+			t = IntersectRaySphere( o, d, sp->radius_ );
+		else if ( auto* b = std::get_if<xo::box>( &s ) )
+			t = IntersectRayBox( o, d, ToVec3( b->half_dim_ ) );
+		else if ( auto* c = std::get_if<xo::capsule>( &s ) )
+			t = IntersectRayCapsule( o, d, c->radius_, 0.5 * c->height_ );
+		else if ( auto* cy = std::get_if<xo::cylinder>( &s ) )
+			t = IntersectRayCylinder( o, d, cy->radius_, 0.5 * cy->height_ );
+		else if ( auto* pl = std::get_if<xo::plane>( &s ) )
+			t = IntersectRayPlane( o, d, ToVec3( pl->normal_ ) );
+		return t < max_dist ? t : no_hit;
+	}
+
+	std::pair<Real, ContactGeometry*> RayCaster::Cast( const Vec3& pos, const Vec3& dir, Real max_dist, const Body* ignore_body ) const
+	{
+		const auto d = xo::normalized( dir );
+		Real best = max_dist;
+		ContactGeometry* hit = nullptr;
+
+		for ( const auto& p : planes_ ) {
+			if ( &p.geom->GetBody() == ignore_body )
+				continue;
+			if ( auto t = Intersect( p, pos, d, best ); t < best ) {
+				best = t;
+				hit = p.geom;
+			}
+		}
+
+		if ( !nodes_.empty() ) {
+			const Vec3 inv_d( 1.0 / d.x, 1.0 / d.y, 1.0 / d.z );
+			std::array<std::uint32_t, 64> stack;
+			size_t top = 0;
+			stack[top++] = 0;
+			while ( top > 0 ) {
+				const auto& n = nodes_[stack[--top]];
+				if ( IntersectAabb( pos, inv_d, n.lower, n.upper, best ) == no_hit )
+					continue;
+				if ( n.count > 0 ) {
+					if ( &prims_[n.first].geom->GetBody() == ignore_body )
+						continue;
+					if ( auto t = Intersect( prims_[n.first], pos, d, best ); t < best ) {
+						best = t;
+						hit = prims_[n.first].geom;
+					}
+				}
+				else {
+					stack[top++] = n.first;
+					stack[top++] = std::uint32_t( &n - nodes_.data() ) + 1;
+				}
+			}
+		}
+
+		return { best, hit };
+	}
+
+	void RayCaster::Cast( const Vec3* pos, const Vec3* dir, size_t n, Real max_dist, Real* dist ) const
+	{
+		for ( size_t i = 0; i < n; ++i )
+			dist[i] = Cast( pos[i], dir[i], max_dist ).first;
+	}
+}
@@ -0,0 +1,81 @@
+/*
+** RayCaster.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include "scone/core/Vec3.h"
+#include "scone/core/Quat.h"
+#include "xo/numerical/constants.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace scone
+{
+	class Model;
+	class Body;
+	class ContactGeometry;
+
+	/// Nearest t >= 0 where ray o + t * d hits a shape centered at the origin, or infinity if there is no hit.
+	/// The direction d must be normalized; t is zero if o is inside the shape.
+	SCONE_API Real IntersectRaySphere( const Vec3& o, const Vec3& d, Real radius );
+	SCONE_API Real IntersectRayBox( const Vec3& o, const Vec3& d, const Vec3& half_dim );
+	SCONE_API Real IntersectRayCylinder( const Vec3& o, const Vec3& d, Real radius, Real half_height ); // along the y-axis
+	SCONE_API Real IntersectRayCapsule( const Vec3& o, const Vec3& d, Real radius, Real half_height ); // along the y-axis
+	SCONE_API Real IntersectRayPlane( const Vec3& o, const Vec3& d, const Vec3& normal ); // half space behind the plane
+
+	/// Ray caster for the contact geometries of a Model.
+	/// Geometries are stored in a bounding volume hierarchy that is built once and refitted
+	/// when the model time changes or the state is set, so that many rays per time step can be cast at low cost.
+	/// Supported shapes are sphere, box, capsule, cylinder (along the local y-axis) and plane;
+	/// other shapes and mesh geometries are ignored.
+	class SCONE_API RayCaster
+	{
+	public:
+		RayCaster( const Model& model );
+
+		/// Refit the hierarchy to the current body poses, if the model time has changed.
+		void Update();
+		/// Force a refit during the next Update(), called by Model::InvalidateRayCaster() when the state is set.
+		void Invalidate() { time_ = xo::constantsd::NaN(); }
+
+		/// Cast ray from pos in direction dir; returns distance and geometry of the nearest hit, or { max_dist, nullptr }.
+		/// Geometries attached to ignore_body are skipped.
+		std::pair<Real, ContactGeometry*> Cast( const Vec3& pos, const Vec3& dir, Real max_dist, const Body* ignore_body = nullptr ) const;
+		/// Cast n rays at once and write the distance of the nearest hit (or max_dist) for each ray to dist.
+		void Cast( const Vec3* pos, const Vec3* dir, size_t n, Real max_dist, Real* dist ) const;
+
+	private:
+		struct Primitive {
+			ContactGeometry* geom;
+			Real radius; // bounding sphere radius
+			Vec3 pos; // world position
+			Quat ori; // world orientation
+		};
+		struct Node {
+			Vec3 lower;
+			Vec3 upper;
+			std::uint32_t first; // first primitive (leaf) or right child (internal); left child is always the next node
+			std::uint32_t count; // number of primitives (one for leaves), zero for internal nodes
+		};
+
+		void UpdatePrimitives();
+		void Build();
+		std::uint32_t BuildNode( std::uint32_t begin, std::uint32_t end );
+		void Refit();
+		Real Intersect( const Primitive& p, const Vec3& pos, const Vec3& dir, Real max_dist ) const;
+
+		const Model& model_;
+		std::vector<Primitive> prims_;
+		std::vector<Primitive> planes_;
+		std::vector<Node> nodes_;
+		double time_;
+	};
+}
@@ -10,10 +10,11 @@
 
 #include "scone/core/types.h"
 #include "scone/core/platform.h"
+#include "scone/core/ModelArena.h"
 
 namespace scone
 {
-	struct Sensor
+	struct Sensor : public ArenaAllocated
 	{
 		Sensor() = default;
 		Sensor( const Sensor& ) = delete;
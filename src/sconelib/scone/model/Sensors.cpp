@@ -106,6 +106,21 @@ namespace scone
 		return xo::dot_product( direction_, body_.GetLinAccOfPointOnBody( offset_ ) );
 	}
 
+	BodyRayDistanceSensor::BodyRayDistanceSensor( const Body& body, Vec3 ofs, Vec3 dir, Real max_dist ) :
+		BodyPointSensor( body, ofs, dir ),
+		max_distance_( max_dist ),
+		// sensors with a different direction, offset or max_distance must not be merged
+		name_( body.GetName() + stringf( ".RD%g,%g,%g@%g,%g,%g<%g", dir.x, dir.y, dir.z, ofs.x, ofs.y, ofs.z, max_dist ) )
+	{
+		SCONE_ERROR_IF( xo::length( dir ) < REAL_EPSILON, "Invalid direction for ray distance sensor " + body.GetName() );
+	}
+
+	Real BodyRayDistanceSensor::GetValue() const {
+		const auto pos = body_.GetPosOfPointOnBody( offset_ );
+		const auto dir = body_.GetOrientation() * direction_;
+		return body_.GetModel().GetRayIntersection( pos, dir, max_distance_, &body_ ).first;
+	}
+
 	BodyOrientationSensor::BodyOrientationSensor( const Body& body, const Vec3& dir, const String& postfix, Side side ) :
 		body_( body ), dir_( GetSidedAxis( dir, side ) ), name_( GetSidedName( body_.GetName() + postfix, side ) + ".BO" ) {}
 	Real BodyOrientationSensor::GetValue() const {
@@ -187,6 +187,17 @@ namespace scone
 		virtual Real GetValue() const override;
 	};
 
+	// distance to the nearest contact geometry along a ray from a point on a body, in body coordinates
+	// geometries attached to the body itself are ignored
+	struct SCONE_API BodyRayDistanceSensor : public BodyPointSensor
+	{
+		BodyRayDistanceSensor( const Body& body, Vec3 ofs, Vec3 dir, Real max_dist );
+		virtual String GetName() const override { return name_; }
+		virtual Real GetValue() const override;
+		Real max_distance_;
+		const String name_;
+	};
+
 	// this sensor does not work in all directions
 	struct SCONE_API BodyOrientationSensor : public Sensor
 	{
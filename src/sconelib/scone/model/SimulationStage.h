@@ -0,0 +1,16 @@
+/*
+** SimulationStage.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see https://scone.software.
+*/
+
+#pragma once
+
+namespace scone
+{
+	/// Stage up to which the model state must be computed before a component can use it.
+	/// Model types that always compute the full state may ignore this.
+	enum class SimulationStage { Position, Velocity, Dynamics, Acceleration };
+}
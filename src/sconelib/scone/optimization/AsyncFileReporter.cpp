@@ -0,0 +1,199 @@
+/*
+** AsyncFileReporter.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "AsyncFileReporter.h"
+
+#include "Params.h"
+#include "scone/core/Log.h"
+#include "spot/optimizer.h"
+#include "spot/cma_optimizer.h"
+#include "xo/container/container_algorithms.h"
+#include "xo/string/string_tools.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace scone
+{
+	AsyncFileReporter::AsyncFileReporter( const path& root, double min_improvement, size_t max_steps_without_output ) :
+		output_fitness_history_( true ),
+		output_par_history_( false ),
+		history_flush_interval_( 10 ),
+		root_( root ),
+		min_improvement_( min_improvement ),
+		max_steps_without_output_( max_steps_without_output ),
+		last_output_fitness_( 0.0 ),
+		last_output_step_( no_index ),
+		buffered_steps_( 0 ),
+		busy_( false ),
+		stop_( false ),
+		thread_( [this]() { Run(); } )
+	{}
+
+	AsyncFileReporter::~AsyncFileReporter()
+	{
+		FlushHistory();
+		{
+			auto lock = std::scoped_lock( jobs_mutex_ );
+			stop_ = true;
+		}
+		jobs_cv_.notify_one();
+		thread_.join();
+	}
+
+	void AsyncFileReporter::on_start( const spot::optimizer& opt )
+	{
+		last_output_fitness_ = 0.0;
+		last_output_step_ = no_index;
+	}
+
+	void AsyncFileReporter::on_stop( const spot::optimizer& opt, const spot::stop_condition& s )
+	{
+		FlushHistory();
+		Flush();
+	}
+
+	void AsyncFileReporter::on_post_evaluate_population( const spot::optimizer& opt, const spot::search_point_vec& pop, const spot::fitness_vec& fitnesses, bool new_best )
+	{
+		if ( pop.empty() )
+			return;
+
+		const auto step = opt.current_step();
+		const auto minimize = opt.info().minimize();
+		const auto best_it = minimize ? std::min_element( fitnesses.begin(), fitnesses.end() ) : std::max_element( fitnesses.begin(), fitnesses.end() );
+		const auto best_idx = best_it - fitnesses.begin();
+		const auto step_best = *best_it;
+		const auto step_avg = std::accumulate( fitnesses.begin(), fitnesses.end(), 0.0 ) / fitnesses.size();
+
+		// buffer history
+		if ( output_fitness_history_ ) {
+			auto trend = opt.fitness_trend();
+			std::ostringstream str;
+			str << step << "\t" << step_best << "\t" << step_avg << "\t" << xo::median( fitnesses ) << "\t" << trend.slope() << "\t" << trend.offset() << "\n";
+			history_buffer_ += str.str();
+		}
+		if ( output_par_history_ ) {
+			std::ostringstream str;
+			str << step;
+			for ( const auto& v : pop[ best_idx ].values() )
+				str << "\t" << v;
+			str << "\n";
+			par_history_buffer_ += str.str();
+		}
+		if ( ++buffered_steps_ >= history_flush_interval_ )
+			FlushHistory();
+
+		// check if we need to write a .par file
+		bool write_par = false;
+		if ( last_output_step_ == no_index )
+			write_par = new_best;
+		else if ( new_best ) {
+			auto improvement = ( minimize ? last_output_fitness_ - step_best : step_best - last_output_fitness_ ) / std::abs( last_output_fitness_ );
+			write_par = improvement >= min_improvement_;
+		}
+		if ( !write_par && last_output_step_ != no_index && step - last_output_step_ >= max_steps_without_output_ )
+			write_par = true;
+
+		if ( write_par ) {
+			// serialize here, the search point and optimizer state may change before the write
+			ObjectiveInfo info( opt.info() );
+			if ( auto* cma = dynamic_cast<const spot::cma_optimizer*>( &opt ) )
+				info.set_mean_std( cma->current_mean(), cma->current_std() );
+			SearchPoint sp( info, pop[ best_idx ].values() );
+			std::ostringstream str;
+			str << sp;
+
+			auto name = xo::stringf( "%04d_%.3f_%.3f.par", int( step ), step_avg, step_best );
+			PushJob( { root_ / name, str.str(), false, true } );
+			last_output_fitness_ = step_best;
+			last_output_step_ = step;
+		}
+	}
+
+	void AsyncFileReporter::Flush()
+	{
+		auto lock = std::unique_lock( jobs_mutex_ );
+		idle_cv_.wait( lock, [this]() { return jobs_.empty() && !busy_; } );
+	}
+
+	void AsyncFileReporter::PushJob( Job&& job )
+	{
+		{
+			auto lock = std::scoped_lock( jobs_mutex_ );
+			if ( job.coalesce ) {
+				// replace a pending .par write that has not yet started
+				for ( auto& j : jobs_ ) {
+					if ( j.coalesce ) {
+						j = std::move( job );
+						return;
+					}
+				}
+			}
+			jobs_.push_back( std::move( job ) );
+		}
+		jobs_cv_.notify_one();
+	}
+
+	void AsyncFileReporter::FlushHistory()
+	{
+		if ( !history_buffer_.empty() )
+			PushJob( { root_ / "history.txt", std::move( history_buffer_ ), true, false } );
+		if ( !par_history_buffer_.empty() )
+			PushJob( { root_ / "history_par.txt", std::move( par_history_buffer_ ), true, false } );
+		history_buffer_.clear();
+		par_history_buffer_.clear();
+		buffered_steps_ = 0;
+	}
+
+	void AsyncFileReporter::Run()
+	{
+		auto lock = std::unique_lock( jobs_mutex_ );
+		while ( true ) {
+			jobs_cv_.wait( lock, [this]() { return stop_ || !jobs_.empty(); } );
+			if ( jobs_.empty() )
+				break; // stop_ is set and all jobs are done
+			auto job = std::move( jobs_.front() );
+			jobs_.pop_front();
+			busy_ = true;
+			lock.unlock();
+			WriteJob( job );
+			lock.lock();
+			busy_ = false;
+			if ( jobs_.empty() )
+				idle_cv_.notify_all();
+		}
+	}
+
+	void AsyncFileReporter::WriteJob( const Job& job )
+	{
+		if ( job.append ) {
+			// append a batch of complete lines
+			std::ofstream( job.file.str(), std::ios::app | std::ios::binary ) << job.content;
+		}
+		else {
+			// write to temporary file and rename, so readers never see a partially written file
+			auto tmp_file = job.file + ".tmp";
+			{
+				std::ofstream str( tmp_file.str(), std::ios::binary );
+				str << job.content;
+				if ( !str.good() ) {
+					log::error( "Could not write ", tmp_file );
+					return;
+				}
+			}
+			// std::filesystem::rename replaces an existing file, also on Windows
+			std::error_code ec;
+			std::filesystem::rename( tmp_file.str(), job.file.str(), ec );
+			if ( ec )
+				log::error( "Could not rename ", tmp_file, " to ", job.file, ": ", ec.message() );
+		}
+	}
+}
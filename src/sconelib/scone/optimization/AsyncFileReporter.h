@@ -0,0 +1,74 @@
+/*
+** AsyncFileReporter.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include "spot/reporter.h"
+#include "xo/filesystem/path.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace scone
+{
+	/// Optimization file reporter that performs all file I/O on a background thread.
+	/// History lines are buffered and appended in batches; .par files are written to a temporary
+	/// file and renamed when complete. Pending .par writes that have not yet started are replaced
+	/// by newer ones, so a slow file system never stalls the optimizer.
+	class SCONE_API AsyncFileReporter : public spot::reporter
+	{
+	public:
+		AsyncFileReporter( const path& root, double min_improvement, size_t max_steps_without_output );
+		virtual ~AsyncFileReporter();
+
+		virtual void on_start( const spot::optimizer& opt ) override;
+		virtual void on_stop( const spot::optimizer& opt, const spot::stop_condition& s ) override;
+		virtual void on_post_evaluate_population( const spot::optimizer& opt, const spot::search_point_vec& pop, const spot::fitness_vec& fitnesses, bool new_best ) override;
+
+		bool output_fitness_history_;
+		bool output_par_history_;
+		size_t history_flush_interval_;
+
+		// wait until all pending writes are completed
+		void Flush();
+
+	private:
+		struct Job {
+			path file;
+			String content;
+			bool append;
+			bool coalesce;
+		};
+
+		void PushJob( Job&& job );
+		void FlushHistory();
+		void Run();
+		static void WriteJob( const Job& job );
+
+		path root_;
+		double min_improvement_;
+		size_t max_steps_without_output_;
+		double last_output_fitness_;
+		size_t last_output_step_;
+
+		String history_buffer_;
+		String par_history_buffer_;
+		size_t buffered_steps_;
+
+		std::deque<Job> jobs_;
+		std::mutex jobs_mutex_;
+		std::condition_variable jobs_cv_;
+		std::condition_variable idle_cv_;
+		bool busy_;
+		bool stop_;
+		std::thread thread_;
+	};
+}
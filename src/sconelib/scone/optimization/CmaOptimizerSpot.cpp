@@ -17,9 +17,9 @@
 
 namespace scone
 {
-	CmaOptimizer::CmaOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir ) :
+	CmaOptimizer::CmaOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir, const s_ptr<spot::evaluator>& parent_evaluator ) :
 		EsOptimizer( pn, scenario_pn, scenario_dir ),
-		cma_optimizer( *m_Objective, GetSpotEvaluator(),
+		cma_optimizer( *m_Objective, GetSpotEvaluator( evaluator_, parent_evaluator ),
 			spot::cma_options{
 				EsOptimizer::lambda_,
 				EsOptimizer::random_seed,
@@ -50,7 +50,7 @@ namespace scone
 	void CmaOptimizer::SetOutputMode( OutputMode m )
 	{
 		xo_assert( output_mode_ == no_output ); // output mode can only be set once
-		output_mode_ = m;
+		Optimizer::SetOutputMode( m );
 		if ( auto p = MakeSpotReporter( output_mode_ ) )
 			add_reporter( std::move( p ) );
 	}
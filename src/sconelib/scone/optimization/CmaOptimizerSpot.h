@@ -17,7 +17,8 @@ namespace scone
 	class SCONE_API CmaOptimizer : public EsOptimizer, public spot::cma_optimizer
 	{
 	public:
-		CmaOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir );
+		/// Child optimizers pass the evaluator of their parent in parent_evaluator, see GetSpotEvaluator().
+		CmaOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir, const s_ptr<spot::evaluator>& parent_evaluator = nullptr );
 		virtual void SetOutputMode( OutputMode m ) override;
 		virtual ~CmaOptimizer() = default;
 		virtual double GetBestFitness() const override { return best_fitness(); }
@@ -8,15 +8,53 @@
 
 #include "CmaPoolOptimizer.h"
 #include "CmaOptimizerSpot.h"
+#include "ModelObjective.h"
 #include "spot/file_reporter.h"
 #include "opt_tools.h"
 #include "scone/core/Settings.h"
+#include "scone/core/Log.h"
+#include "xo/numerical/math.h"
 
 namespace scone
 {
+	// adds the simulated time of the evaluations of a child optimization to a shared counter,
+	// or the number of evaluations for objectives without a Model;
+	// evaluations found in the evaluation cache add no simulated time, which matches the negligible time they take
+	class EvaluationWorkReporter : public spot::reporter
+	{
+	public:
+		EvaluationWorkReporter( std::atomic<double>& work ) : work_( work ), prev_simulated_time_( 0.0 ) {}
+		virtual void on_post_evaluate_population( const spot::optimizer& opt, const spot::search_point_vec& pop, const spot::fitness_vec& fitnesses, bool new_best ) override {
+			double work = double( pop.size() );
+			if ( auto* mo = dynamic_cast<const ModelObjective*>( &dynamic_cast<const Optimizer&>( opt ).GetObjective() ) ) {
+				const auto simulated_time = mo->GetSimulatedTime();
+				work = simulated_time - prev_simulated_time_;
+				prev_simulated_time_ = simulated_time;
+			}
+			for ( auto w = work_.load(); !work_.compare_exchange_weak( w, w + work ); );
+		}
+	private:
+		std::atomic<double>& work_;
+		TimeInSeconds prev_simulated_time_;
+	};
+
+	// adapts the concurrency of a CmaPoolOptimizer after each step
+	class AdaptiveConcurrencyReporter : public spot::reporter
+	{
+	public:
+		AdaptiveConcurrencyReporter( CmaPoolOptimizer& pool ) : pool_( pool ) {}
+		virtual void on_post_step( const spot::optimizer& opt ) override { pool_.UpdateConcurrency(); }
+	private:
+		CmaPoolOptimizer& pool_;
+	};
+
 	CmaPoolOptimizer::CmaPoolOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir ) :
 		Optimizer( pn, scenario_pn, scenario_dir ),
-		optimizer_pool( *m_Objective, GetSpotEvaluator(), pn )
+		optimizer_pool( *m_Objective, GetSpotEvaluator( evaluator_ ), pn ),
+		evaluation_work_( 0.0 ),
+		window_steps_( 0 ),
+		prev_throughput_( 0.0 ),
+		concurrency_direction_( 1 )
 	{
 		// re-initialize these parameters because we want different defaults
 		INIT_PROP( pn, prediction_window_, window_size );
@@ -28,8 +66,10 @@ namespace scone
 		INIT_PROP( pn, active_optimizations_, 6 );
 		INIT_PROP( pn, concurrent_optimizations_, 2 );
 		INIT_PROP( pn, random_seed_, 1 );
+		INIT_PROP( pn, adaptive_concurrency, false );
+		INIT_PROP( pn, adaptive_concurrency_window, 20 );
 
-		auto flag_parameters = CmaOptimizer( pn, scenario_pn, scenario_dir );
+		auto flag_parameters = CmaOptimizer( pn, scenario_pn, scenario_dir, evaluator_ );
 	}
 
 	void CmaPoolOptimizer::RunImpl()
@@ -44,12 +84,15 @@ namespace scone
 			props_.back().set( "output_root", GetOutputFolder() ); // make sure output is written to subdirectory
 			props_.back().set( "log_level", (int)xo::log::level::never ); // children don't log?
 
-			// create optimizer
-			auto o = std::make_unique< CmaOptimizer >( props_.back(), scenario_pn_copy_, m_Objective->GetExternalResourceDir() );
+			// create optimizer, which shares the evaluator (and its worker processes) of this optimizer
+			auto o = std::make_unique< CmaOptimizer >( props_.back(), scenario_pn_copy_, m_Objective->GetExternalResourceDir(), evaluator_ );
 			o->PrepareOutputFolder();
 
 			o->add_reporter( MakeSpotFileReporter( *o ) );
+			if ( adaptive_concurrency )
+				o->add_reporter( std::make_unique< EvaluationWorkReporter >( evaluation_work_ ) );
 
+			o->ShareStatusOutput( *this );
 			o->SetOutputMode( output_mode_ );
 			push_back( std::move( o ) );
 		}
@@ -58,18 +101,45 @@ namespace scone
 		add_reporter( MakeSpotFileReporter( *this ) );
 
 		add_reporter( std::make_unique< CmaPoolOptimizerReporter >() );
+		if ( adaptive_concurrency )
+			add_reporter( std::make_unique< AdaptiveConcurrencyReporter >( *this ) );
 
 		// reset the id, so that the ProgressDock can interpret OutputStatus() as a general message
 		id_.clear();
 
+		window_timer_.restart();
 		run();
 	}
 
+	void CmaPoolOptimizer::UpdateConcurrency()
+	{
+		if ( ++window_steps_ < adaptive_concurrency_window )
+			return;
+
+		// measure throughput over the last window, in simulated time per second, so that it does not decrease
+		// when simulations get longer as the optimization progresses
+		const auto throughput = evaluation_work_.exchange( 0.0 ) / window_timer_().secondsd();
+		window_timer_.restart();
+		window_steps_ = 0;
+
+		// hill-climb on throughput: keep changing concurrency in the same direction while it improves
+		if ( prev_throughput_ > 0.0 && throughput < 1.02 * prev_throughput_ )
+			concurrency_direction_ = -concurrency_direction_;
+		prev_throughput_ = throughput;
+		const auto prev_concurrency = concurrent_optimizations_;
+		concurrent_optimizations_ = size_t( xo::clamped<int>( int( concurrent_optimizations_ ) + concurrency_direction_, 1, int( active_optimizations_ ) ) );
+		if ( concurrent_optimizations_ != prev_concurrency )
+			log::debug( "Simulation throughput: ", throughput, "; concurrent_optimizations ", prev_concurrency, " -> ", concurrent_optimizations_ );
+	}
+
 	void CmaPoolOptimizer::SetOutputMode( OutputMode m )
 	{
-		output_mode_ = m;
-		for ( auto& o : optimizers_ )
-			dynamic_cast<Optimizer&>( *o ).SetOutputMode( m );
+		Optimizer::SetOutputMode( m );
+		for ( auto& o : optimizers_ ) {
+			auto& opt = dynamic_cast<Optimizer&>( *o );
+			opt.ShareStatusOutput( *this );
+			opt.SetOutputMode( m );
+		}
 	}
 
 	void CmaPoolOptimizerReporter::on_start( const spot::optimizer& opt )
@@ -11,6 +11,8 @@
 #include "Optimizer.h"
 #include "spot/optimizer_pool.h"
 #include "xo/system/log_sink.h"
+#include "xo/time/timer.h"
+#include <atomic>
 
 namespace scone
 {
@@ -48,11 +50,27 @@ namespace scone
 		/// Random seed of the first optimization; default = 1.
 		long random_seed_;
 
+		/// Adapt concurrent_optimizations during optimization based on the measured simulated time per second
+		/// (evaluations per second for objectives without a Model); default = 0.
+		bool adaptive_concurrency;
+
+		/// Number of steps over which evaluation throughput is measured for adaptive_concurrency; default = 20.
+		size_t adaptive_concurrency_window;
+
 		virtual double GetBestFitness() const override { return best_fitness(); }
 
+		// update concurrent_optimizations based on measured throughput, called after each step
+		void UpdateConcurrency();
+
 	protected:
 		virtual void RunImpl() override;
 		std::vector< PropNode > props_;
+
+		std::atomic<double> evaluation_work_; // simulated time or number of evaluations, see adaptive_concurrency
+		size_t window_steps_;
+		xo::timer window_timer_;
+		double prev_throughput_;
+		int concurrency_direction_;
 	};
 
 	class SCONE_API CmaPoolOptimizerReporter : public spot::reporter
@@ -7,6 +7,7 @@
 */
 
 #include "EsOptimizer.h"
+#include "ModelObjective.h"
 #include "xo/string/string_tools.h"
 #include "xo/filesystem/filesystem.h"
 #include "spot/optimizer.h"
@@ -103,6 +104,9 @@ namespace scone
 			pn.set( "best", opt.best_fitness() );
 			pn.set( "best_gen", opt.current_step() );
 		}
+		if ( auto* mo = dynamic_cast<const ModelObjective*>( &es_opt.GetObjective() ) )
+			if ( auto pc = mo->TakePerfCounters(); pc.simulations > 0 || pc.cached_evaluations > 0 )
+				pn.add_child( "performance", pc.ToPropNode() );
 		es_opt.OutputStatus( std::move( pn ) );
 	}
 }
@@ -33,7 +33,7 @@ namespace scone
 
 	EvaOptimizer::EvaOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir ) :
 		EsOptimizer( pn, scenario_pn, scenario_dir ),
-		eva_optimizer( *m_Objective, GetSpotEvaluator(), make_eva_options( pn ) ),
+		eva_optimizer( *m_Objective, GetSpotEvaluator( evaluator_ ), make_eva_options( pn ) ),
 		INIT_MEMBER( pn, max_errors, max_errors_ )
 	{
 		SCONE_ASSERT( GetObjective().dim() > 0 );
@@ -58,7 +58,7 @@ namespace scone
 	void EvaOptimizer::SetOutputMode( OutputMode m )
 	{
 		xo_assert( output_mode_ == no_output ); // output mode can only be set once
-		output_mode_ = m;
+		Optimizer::SetOutputMode( m );
 		if ( auto p = MakeSpotReporter( output_mode_ ) )
 			add_reporter( std::move( p ) );
 	}
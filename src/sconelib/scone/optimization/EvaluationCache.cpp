@@ -0,0 +1,194 @@
+/*
+** EvaluationCache.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "EvaluationCache.h"
+
+#include "scone/core/Log.h"
+#include "scone/core/version.h"
+#include "xo/filesystem/filesystem.h"
+#include "xo/serialization/prop_node_serializer_zml.h"
+#include "xo/string/string_tools.h"
+#include "xo/system/error_code.h"
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/file.h>
+#	include <unistd.h>
+#endif
+
+namespace scone
+{
+	// 64-bit FNV-1a hash
+	static void HashBytes( EvaluationCache::key_t& h, const void* data, size_t size ) {
+		auto* bytes = static_cast<const unsigned char*>( data );
+		for ( size_t i = 0; i < size; ++i )
+			h = ( h ^ bytes[ i ] ) * 0x100000001b3ull;
+	}
+	static void HashString( EvaluationCache::key_t& h, const String& str ) {
+		HashBytes( h, str.data(), str.size() );
+	}
+	static const EvaluationCache::key_t hash_offset_basis = 0xcbf29ce484222325ull;
+
+	std::shared_ptr<EvaluationCache> EvaluationCache::GetCache( const path& file )
+	{
+		// caches are destroyed with their last user, so the writer thread is never joined during static destruction
+		static std::mutex caches_mutex;
+		static std::map<String, std::weak_ptr<EvaluationCache>> caches;
+		auto lock = std::scoped_lock( caches_mutex );
+		auto& weak_cache = caches[ file.str() ];
+		auto cache = weak_cache.lock();
+		if ( !cache ) {
+			cache.reset( new EvaluationCache( file ) );
+			weak_cache = cache;
+		}
+		return cache;
+	}
+
+	EvaluationCache::EvaluationCache( const path& file ) :
+		file_( file ),
+		writing_( false ),
+		stop_( false )
+	{
+		std::ifstream str( file_.str() );
+		String key_str, fitness_str;
+		while ( str >> key_str >> fitness_str )
+			entries_[ std::strtoull( key_str.c_str(), nullptr, 16 ) ] = std::strtod( fitness_str.c_str(), nullptr );
+		if ( !entries_.empty() )
+			log::debug( "Read ", entries_.size(), " entries from evaluation cache ", file_ );
+
+		writer_thread_ = std::thread( [this]() { Run(); } );
+	}
+
+	EvaluationCache::~EvaluationCache()
+	{
+		{
+			auto lock = std::scoped_lock( mutex_ );
+			stop_ = true;
+		}
+		pending_cv_.notify_one();
+		writer_thread_.join();
+	}
+
+	std::optional<double> EvaluationCache::Find( key_t key ) const
+	{
+		auto lock = std::scoped_lock( mutex_ );
+		if ( auto it = entries_.find( key ); it != entries_.end() )
+			return it->second;
+		else return {};
+	}
+
+	void EvaluationCache::Store( key_t key, double fitness )
+	{
+		{
+			auto lock = std::scoped_lock( mutex_ );
+			entries_[ key ] = fitness;
+			pending_lines_ += xo::stringf( "%016llx %.17g\n", static_cast<unsigned long long>( key ), fitness );
+		}
+		pending_cv_.notify_one();
+	}
+
+	void EvaluationCache::Flush()
+	{
+		auto lock = std::unique_lock( mutex_ );
+		written_cv_.wait( lock, [this]() { return pending_lines_.empty() && !writing_; } );
+	}
+
+	void EvaluationCache::Run()
+	{
+		auto lock = std::unique_lock( mutex_ );
+		while ( true ) {
+			pending_cv_.wait( lock, [this]() { return stop_ || !pending_lines_.empty(); } );
+			if ( pending_lines_.empty() )
+				break; // stop_ is set and all entries are written
+
+			// write all pending entries at once, without holding the lock
+			auto lines = std::move( pending_lines_ );
+			pending_lines_.clear();
+			writing_ = true;
+			lock.unlock();
+			if ( !AppendToFile( lines ) )
+				log::warning( "Could not write to evaluation cache ", file_ );
+			lock.lock();
+			writing_ = false;
+			if ( pending_lines_.empty() )
+				written_cv_.notify_all();
+		}
+	}
+
+	bool EvaluationCache::AppendToFile( const String& lines ) const
+	{
+		// append while holding an exclusive lock, so that lines of different processes are never interleaved
+#ifdef _WIN32
+		auto file = ::CreateFileA( file_.str().c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+		if ( file == INVALID_HANDLE_VALUE )
+			return false;
+		OVERLAPPED overlapped{};
+		bool ok = ::LockFileEx( file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped );
+		DWORD written = 0;
+		ok = ok && ::WriteFile( file, lines.data(), DWORD( lines.size() ), &written, nullptr ) && written == lines.size();
+		::UnlockFileEx( file, 0, MAXDWORD, MAXDWORD, &overlapped );
+		::CloseHandle( file );
+		return ok;
+#else
+		int fd = ::open( file_.str().c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644 );
+		if ( fd < 0 )
+			return false;
+		bool ok = ::flock( fd, LOCK_EX ) == 0;
+		for ( size_t written = 0; ok && written < lines.size(); ) {
+			auto count = ::write( fd, lines.data() + written, lines.size() - written );
+			ok = count > 0;
+			written += ok ? count : 0;
+		}
+		::flock( fd, LOCK_UN );
+		::close( fd );
+		return ok;
+#endif
+	}
+
+	size_t EvaluationCache::size() const
+	{
+		auto lock = std::scoped_lock( mutex_ );
+		return entries_.size();
+	}
+
+	EvaluationCache::key_t EvaluationCache::GetScenarioKey( const PropNode& pn, const ExternalResourceContainer& resources )
+	{
+		key_t h = hash_offset_basis;
+		HashString( h, xo::to_str( GetSconeVersion() ) );
+
+		xo::error_code ec;
+		std::ostringstream pn_str;
+		pn_str << xo::prop_node_serializer_zml_concise( pn, &ec );
+		HashString( h, pn_str.str() );
+
+		for ( const auto& r : resources.GetVec() ) {
+			std::ifstream str( r.filename_.str(), std::ios::binary );
+			std::ostringstream content;
+			content << str.rdbuf();
+			HashString( h, r.filename_.filename().str() );
+			HashString( h, content.str() );
+		}
+		return h;
+	}
+
+	EvaluationCache::key_t EvaluationCache::GetEvaluationKey( key_t scenario_key, const std::vector<double>& values )
+	{
+		key_t h = scenario_key;
+		HashBytes( h, values.data(), values.size() * sizeof( double ) );
+		return h;
+	}
+}
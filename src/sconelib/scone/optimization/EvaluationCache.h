@@ -0,0 +1,68 @@
+/*
+** EvaluationCache.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include "scone/core/PropNode.h"
+#include "scone/core/ExternalResourceContainer.h"
+#include "xo/filesystem/path.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace scone
+{
+	/// Persistent cache of fitness values, stored as an append-only text file.
+	/// Each line contains a 64-bit key (hex) and a fitness value; later entries override earlier ones.
+	/// The cache can safely be shared between threads. New entries are appended in batches by a writer thread,
+	/// which holds an exclusive file lock while writing, so that the file can be shared between processes.
+	class SCONE_API EvaluationCache
+	{
+	public:
+		using key_t = std::uint64_t;
+
+		// get cache for file, which is loaded on first use and shared by all users of the same file
+		static std::shared_ptr<EvaluationCache> GetCache( const path& file );
+		~EvaluationCache();
+
+		std::optional<double> Find( key_t key ) const;
+		void Store( key_t key, double fitness );
+		size_t size() const;
+
+		// wait until all stored entries are written to file
+		void Flush();
+
+		// compute a key for a scenario, including the SCONE version and the contents of all external resources
+		static key_t GetScenarioKey( const PropNode& pn, const ExternalResourceContainer& resources );
+
+		// combine a scenario key with parameter values
+		static key_t GetEvaluationKey( key_t scenario_key, const std::vector<double>& values );
+
+	private:
+		EvaluationCache( const path& file );
+		void Run();
+		bool AppendToFile( const String& lines ) const;
+
+		path file_;
+		std::unordered_map<key_t, double> entries_;
+		String pending_lines_; // entries that are not yet written
+		bool writing_;
+		bool stop_;
+		mutable std::mutex mutex_;
+		std::condition_variable pending_cv_;
+		std::condition_variable written_cv_;
+		std::thread writer_thread_;
+	};
+}
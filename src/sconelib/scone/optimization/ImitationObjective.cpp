@@ -17,8 +17,10 @@
 #include "scone/core/StorageIo.h"
 #include "scone/model/Muscle.h"
 #include "scone/core/profiler_config.h"
+#include "scone/core/ParallelReduce.h"
 
 #include <vector>
+#include <algorithm>
 
 #include "xo/container/prop_node.h"
 #include "xo/container/container_tools.h"
@@ -30,6 +32,9 @@ namespace scone
 	{
 		file = FindFile( pn.get<path>( "file" ) );
 		INIT_PROP( pn, frame_delta, 1 );
+		INIT_PROP( pn, evaluation_chunks, 1 );
+		INIT_PROP( pn, chunk_warmup_frames, 10 );
+		SCONE_ERROR_IF( evaluation_chunks < 1, "evaluation_chunks must be at least 1" );
 
 		if ( signature_postfix.empty() )
 			signature_postfix = "Imitation";
@@ -68,50 +73,136 @@ namespace scone
 	ImitationObjective::~ImitationObjective()
 	{}
 
-	void ImitationObjective::AdvanceSimulationTo( Model& model, TimeInSeconds t ) const
+	namespace
 	{
-		SCONE_PROFILE_FUNCTION( model.GetProfiler() );
+		struct ChunkResult {
+			std::vector<double> frame_errors;
+			PerfCounters perf_counters;
+			String error_message; // non-empty if the chunk could not be evaluated
+		};
+	}
 
-		if ( !model.GetUserData().has_key( "IM_fra" ) )
-		{
-			model.GetUserData()["IM_fra"] = 0;
-			model.GetUserData()["IM_res"] = 0.0;
-
-			// add sensor data
-			auto& ds = model.GetSensorDelayStorage();
-			for ( index_t fidx = 1; fidx < m_Storage.GetFrameCount(); ++fidx )
-			{
-				const auto& sf = m_Storage.GetFrame( fidx );
-				ds.AddFrame( sf.GetTime() );
-				for ( index_t cidx = 0; cidx < m_SensorChannels.size(); ++cidx )
-					ds.Back()[cidx] = sf[m_SensorChannels[cidx]];
+	result<fitness_t> ImitationObjective::EvaluateModelForPoint( Model& m, const SearchPoint& point, const xo::stop_token& st ) const
+	{
+		if ( evaluation_chunks == 1 )
+			return EvaluateModel( m, st );
+
+		// divide the evaluated frames into chunks, starting each chunk with a number of warm-up frames
+		// the first chunk is evaluated using m, the other chunks each create their own model
+		const auto total_frames = ( m_Storage.GetFrameCount() - 1 ) / frame_delta + 1;
+		const auto chunks = std::min( evaluation_chunks, total_frames );
+		auto chunk_results = ParallelMap( chunks, [&]( index_t chunk_idx ) {
+			ChunkResult cr;
+			try {
+				if ( st.stop_requested() ) {
+					cr.error_message = "Optimization canceled";
+					return cr;
+				}
+				const index_t first_frame = chunk_idx * total_frames / chunks;
+				const index_t end_frame = ( chunk_idx + 1 ) * total_frames / chunks;
+				const index_t warmup_frame = first_frame > chunk_warmup_frames ? first_frame - chunk_warmup_frames : 0;
+				if ( chunk_idx == 0 ) {
+					InitSensorData( m );
+					EvaluateFrames( m, first_frame, end_frame, GetDuration(), &cr.frame_errors );
+				}
+				else {
+					SearchPoint params( point );
+					auto model = CreateModelFromParams( params );
+					InitSensorData( *model );
+					if ( warmup_frame < first_frame )
+						EvaluateFrames( *model, warmup_frame, first_frame, GetDuration() );
+					EvaluateFrames( *model, first_frame, end_frame, GetDuration(), &cr.frame_errors );
+					cr.perf_counters = model->GetPerfCounters();
+				}
+			}
+			catch ( const std::exception& e ) {
+				cr.error_message = e.what();
 			}
+			return cr;
+		} );
+
+		// reduce the errors of all frames using a fixed tree, so that the result depends on neither
+		// the number of chunks nor the number of evaluation threads
+		std::vector<double> frame_errors;
+		for ( const auto& cr : chunk_results ) {
+			AddPerfCounters( cr.perf_counters );
+			frame_errors.insert( frame_errors.end(), cr.frame_errors.begin(), cr.frame_errors.end() );
+		}
+		const auto frame_count = frame_errors.size();
+		for ( const auto& cr : chunk_results )
+			if ( !cr.error_message.empty() )
+				return xo::error_message( cr.error_message );
+		if ( frame_count == 0 )
+			return xo::error_message( "No frames were evaluated" );
+
+		// store the combined result in m, which is used by GetResult() and GetReport()
+		auto& is = m.GetSlot( m_StateSlot );
+		is.initialized = true;
+		is.result = 100 * TreeSum( frame_errors ) / m_ExcitationChannels.size();
+		is.frames = frame_count;
+		return GetResult( m );
+	}
+
+	void ImitationObjective::InitSensorData( Model& model ) const
+	{
+		auto& ds = model.GetSensorDelayStorage();
+		for ( index_t fidx = 1; fidx < m_Storage.GetFrameCount(); ++fidx )
+		{
+			const auto& sf = m_Storage.GetFrame( fidx );
+			ds.AddFrame( sf.GetTime() );
+			for ( index_t cidx = 0; cidx < m_SensorChannels.size(); ++cidx )
+				ds.Back()[cidx] = sf[m_SensorChannels[cidx]];
 		}
+	}
 
-		// compute result
+	std::pair<double, size_t> ImitationObjective::EvaluateFrames( Model& model, index_t first_frame, index_t end_frame, TimeInSeconds t, std::vector<double>* frame_errors ) const
+	{
 		double result = 0.0;
-		index_t frame_start = model.GetUserData().get< index_t >( "IM_fra" );
 		index_t frame_count = 0;
-
+		for ( index_t fidx = first_frame * frame_delta; fidx < end_frame * frame_delta && fidx < m_Storage.GetFrameCount() && m_Storage.GetFrame( fidx ).GetTime() <= t; fidx += frame_delta )
 		{
-			for ( index_t fidx = frame_start * frame_delta; fidx < m_Storage.GetFrameCount() && m_Storage.GetFrame( fidx ).GetTime() <= t; fidx += frame_delta )
-			{
-				const auto& f = m_Storage.GetFrame( fidx );
+			const auto& f = m_Storage.GetFrame( fidx );
 
-				// set state and compare output
-				model.SetStateValues( f.GetValues(), f.GetTime() );
+			// set state and compare output
+			model.SetStateValues( f.GetValues(), f.GetTime() );
+			if ( frame_errors ) {
+				// keep the error of each frame, for reductions that do not depend on how frames are divided
+				double frame_error = 0.0;
+				for ( index_t cidx = 0; cidx < m_ExcitationChannels.size(); ++cidx )
+					frame_error += abs( model.GetMuscles()[cidx]->GetExcitation() - f[m_ExcitationChannels[cidx]] );
+				frame_errors->push_back( frame_error );
+				result += frame_error;
+			}
+			else {
 				for ( index_t cidx = 0; cidx < m_ExcitationChannels.size(); ++cidx )
 					result += abs( model.GetMuscles()[cidx]->GetExcitation() - f[m_ExcitationChannels[cidx]] );
-				++frame_count;
 			}
+			++frame_count;
 		}
+		return { result, frame_count };
+	}
+
+	void ImitationObjective::AdvanceSimulationTo( Model& model, TimeInSeconds t ) const
+	{
+		SCONE_PROFILE_FUNCTION( model.GetProfiler() );
+
+		auto& is = model.GetSlot( m_StateSlot );
+		if ( !is.initialized )
+		{
+			is.initialized = true;
+			InitSensorData( model );
+		}
+
+		// compute result
+		index_t frame_start = is.frames;
+		auto [result, frame_count] = EvaluateFrames( model, frame_start, m_Storage.GetFrameCount(), t );
 
 		if ( frame_count > 0 )
 		{
 			result = 100 * result / m_ExcitationChannels.size();
 			//log::trace( "t=", t, " frames=", frame_count, " start=", frame_start, " result=", result );
-			model.GetUserData()["IM_res"] = result + model.GetUserData().get< double >( "IM_res" );
-			model.GetUserData()["IM_fra"] = frame_start + frame_count;
+			is.result += result;
+			is.frames = frame_start + frame_count;
 		}
 	}
 
@@ -124,7 +215,9 @@ namespace scone
 
 	fitness_t ImitationObjective::GetResult( Model& m ) const
 	{
-		return m.GetUserData().get< fitness_t >( "IM_res" ) / ( m.GetUserData().get< index_t >( "IM_fra" ) );
+		const auto* is = m.TryGetSlot( m_StateSlot );
+		SCONE_ERROR_IF( !is, "No imitation results available" );
+		return is->result / is->frames;
 	}
 
 	PropNode ImitationObjective::GetReport( Model& m ) const
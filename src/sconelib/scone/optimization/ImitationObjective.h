@@ -17,6 +17,7 @@
 #include <vector>
 #include "xo/filesystem/path.h"
 #include "scone/core/Storage.h"
+#include "scone/model/ModelSlot.h"
 #include "ModelObjective.h"
 
 namespace scone
@@ -34,12 +35,31 @@ namespace scone
 		/// Number of frames to skip during each evaluation step; default = 1.
 		size_t frame_delta;
 
+		/// Number of chunks into which the recorded frames are divided, each evaluated in parallel with its own model.
+		/// The result does not depend on the number of threads, but may depend on the number of chunks for controllers with internal state; default = 1 (no chunks).
+		size_t evaluation_chunks;
+
+		/// Number of evaluated frames before each chunk that are not included in the result, to settle controller state; default = 10.
+		size_t chunk_warmup_frames;
+
+		virtual result<fitness_t> EvaluateModelForPoint( Model& m, const SearchPoint& point, const xo::stop_token& st ) const override;
 		virtual void AdvanceSimulationTo( Model& m, TimeInSeconds t ) const override;
 		virtual TimeInSeconds GetDuration() const override;
 		virtual fitness_t GetResult( Model& m ) const override;
 		virtual PropNode GetReport( Model& m ) const override;
 
 	private:
+		// intermediate results, stored in the model
+		struct ImitationState {
+			bool initialized = false;
+			index_t frames = 0;
+			double result = 0.0;
+		};
+		ModelSlot<ImitationState> m_StateSlot;
+
+		void InitSensorData( Model& model ) const;
+		std::pair<double, size_t> EvaluateFrames( Model& model, index_t first_frame, index_t end_frame, TimeInSeconds t, std::vector<double>* frame_errors = nullptr ) const;
+
 		Storage<> m_Storage;
 		std::vector< index_t > m_ExcitationChannels;
 		std::vector< index_t > m_SensorChannels;
@@ -33,7 +33,7 @@ namespace scone
 
 	MesOptimizer::MesOptimizer( const PropNode& pn, const PropNode& scenario_pn, const path& scenario_dir ) :
 		EsOptimizer( pn, scenario_pn, scenario_dir ),
-		mes_optimizer( *m_Objective, GetSpotEvaluator(), make_mes_options( pn ) ),
+		mes_optimizer( *m_Objective, GetSpotEvaluator( evaluator_ ), make_mes_options( pn ) ),
 		INIT_MEMBER( pn, max_errors, max_errors_ )
 	{
 		SCONE_ASSERT( GetObjective().dim() > 0 );
@@ -55,7 +55,7 @@ namespace scone
 	void MesOptimizer::SetOutputMode( OutputMode m )
 	{
 		xo_assert( output_mode_ == no_output ); // output mode can only be set once
-		output_mode_ = m;
+		Optimizer::SetOutputMode( m );
 		if ( auto p = MakeSpotReporter( output_mode_ ) )
 			add_reporter( std::move( p ) );
 	}
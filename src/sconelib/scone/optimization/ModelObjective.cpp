@@ -10,20 +10,35 @@
 
 #include "scone/core/Factories.h"
 #include "scone/core/Log.h"
+#include "scone/core/ModelArena.h"
 #include "xo/filesystem/filesystem.h"
 #include "opt_tools.h"
 #include "scone/core/profiler_config.h"
+#include <atomic>
+#include <utility>
 
 namespace scone
 {
 	ModelObjective::ModelObjective( const PropNode& props, const path& find_file_folder ) :
 		Objective( props, find_file_folder ),
+		INIT_MEMBER( props, use_param_binding_plan, false ),
+		INIT_MEMBER( props, reuse_models, false ),
+		INIT_MEMBER( props, use_evaluation_cache, false ),
+		INIT_MEMBER( props, evaluation_cache_file, GetFolder( SconeFolder::Results ) / "evaluation_cache.txt" ),
+		INIT_MEMBER( props, use_model_arena, false ),
 		objective_pn_( props ),
-		evaluation_step_size_( XO_IS_DEBUG_BUILD ? 0.01 : 0.25 )
+		evaluation_step_size_( XO_IS_DEBUG_BUILD ? 0.01 : 0.25 ),
+		model_param_count_( 0 ),
+		scenario_key_( 0 ),
+		simulated_time_( 0 )
 	{
+		// controllers and measures that are replaced by Reparameterize() would leave unused blocks in the arena
+		SCONE_ERROR_IF( reuse_models && use_model_arena, "reuse_models cannot be combined with use_model_arena" );
+
 		// create internal model using the ORIGINAL prop_node to flag unused model props and create par_info_
 		auto model_fp = FindFactoryProps( GetModelFactory(), props, "Model" );
 		model_ = CreateModel( model_fp, info_, GetExternalResourceDir() );
+		model_param_count_ = info_.dim();
 
 		// create a controller that's defined OUTSIDE the model prop_node, using the ORIGINAL prop_node for flagging
 		if ( auto controller_fp = TryFindFactoryProps( GetControllerFactory(), props, "Controller" ) )
@@ -45,22 +60,103 @@ namespace scone
 		if ( info_.dim() > 0 && !model_->GetMeasure() )
 			log::warning( "Warning: Model has free parameters but no Measure" );
 
+		if ( reuse_models && !CanReuseModels() )
+			log::warning( "Models cannot be reused because the Model has free parameters or there is no external Controller or Measure" );
+
 		signature_ = model_->GetSignature();
 
 		external_resources_.Add( model_->GetExternalResources() );
+
+		if ( use_evaluation_cache ) {
+			evaluation_cache_ = EvaluationCache::GetCache( evaluation_cache_file );
+			scenario_key_ = EvaluationCache::GetScenarioKey( objective_pn_, external_resources_ );
+		}
 	}
 
 	result<fitness_t> ModelObjective::evaluate( const SearchPoint& point, const xo::stop_token& st ) const
+	{
+		if ( evaluation_cache_ && !st.stop_requested() )
+		{
+			const auto key = EvaluationCache::GetEvaluationKey( scenario_key_, point.values() );
+			if ( auto fitness = evaluation_cache_->Find( key ) ) {
+				std::scoped_lock lock( perf_counters_mutex_ );
+				++perf_counters_.cached_evaluations;
+				return *fitness;
+			}
+			auto r = EvaluateUncached( point, st );
+			if ( r && !st.stop_requested() )
+				evaluation_cache_->Store( key, r.value() );
+			return r;
+		}
+		else return EvaluateUncached( point, st );
+	}
+
+	result<fitness_t> ModelObjective::EvaluateUncached( const SearchPoint& point, const xo::stop_token& st ) const
 	{
 		if ( !st.stop_requested() )
 		{
+			if ( CanReuseModels() ) {
+				// check out an idle model and re-parameterize it, or create a new one
+				ModelUP model;
+				{
+					std::scoped_lock lock( reusable_models_mutex_ );
+					if ( !reusable_models_.empty() ) {
+						model = std::move( reusable_models_.back() );
+						reusable_models_.pop_back();
+					}
+				}
+				SearchPoint params( point );
+				if ( model ) {
+					model->Reparameterize( params, controller_factory_props_, measure_factory_props_ );
+					model->SetSimulationEndTime( GetDuration() );
+				}
+				else model = CreateModelFromParams( params );
+				auto r = EvaluateAndCount( *model, point, st );
+
+				// return the model to the pool, models of evaluations that throw are discarded
+				std::scoped_lock lock( reusable_models_mutex_ );
+				if ( reusable_models_.size() < max_reusable_models )
+					reusable_models_.push_back( std::move( model ) );
+				return r;
+			}
+			if ( use_param_binding_plan ) {
+				auto model = CreateModelFromBindingPlan( point );
+				return EvaluateAndCount( *model, point, st );
+			}
 			SearchPoint params( point );
 			auto model = CreateModelFromParams( params );
-			return EvaluateModel( *model, st );
+			return EvaluateAndCount( *model, point, st );
 		}
 		else return xo::error_message( "Optimization canceled" );
 	}
 
+	result<fitness_t> ModelObjective::EvaluateAndCount( Model& m, const SearchPoint& point, const xo::stop_token& st ) const
+	{
+		auto r = EvaluateModelForPoint( m, point, st );
+		AddPerfCounters( m.GetPerfCounters() );
+		std::scoped_lock lock( perf_counters_mutex_ );
+		simulated_time_ += m.GetTime();
+		return r;
+	}
+
+	void ModelObjective::AddPerfCounters( const PerfCounters& pc ) const
+	{
+		std::scoped_lock lock( perf_counters_mutex_ );
+		perf_counters_ += pc;
+	}
+
+	PerfCounters ModelObjective::TakePerfCounters() const
+	{
+		std::scoped_lock lock( perf_counters_mutex_ );
+		return std::exchange( perf_counters_, PerfCounters() );
+	}
+
+	TimeInSeconds ModelObjective::GetSimulatedTime() const
+	{
+		std::scoped_lock lock( perf_counters_mutex_ );
+		return simulated_time_;
+	}
+
 	result<fitness_t> ModelObjective::EvaluateModel( Model& m, const xo::stop_token& st ) const
 	{
 		m.SetSimulationEndTime( GetDuration() );
@@ -73,8 +169,17 @@ namespace scone
 		return GetResult( m );
 	}
 
+	result<fitness_t> ModelObjective::EvaluateModelForPoint( Model& m, const SearchPoint& point, const xo::stop_token& st ) const
+	{
+		return EvaluateModel( m, st );
+	}
+
 	ModelUP ModelObjective::CreateModelFromParams( Params& par ) const
 	{
+		// components created within arena_scope are stored in the arena, which is moved to the model afterwards
+		auto arena = use_model_arena ? std::make_unique<ModelArena>() : nullptr;
+		ModelArenaScope arena_scope( arena.get() );
+
 		auto model = CreateModel( model_factory_props_, par, GetExternalResourceDir() );
 		model->SetSimulationEndTime( GetDuration() );
 
@@ -84,6 +189,9 @@ namespace scone
 		if ( measure_factory_props_ ) // A measure was defined OUTSIDE the model prop_node
 			model->CreateMeasure( measure_factory_props_, par );
 
+		if ( arena )
+			model->SetArena( std::move( arena ) );
+
 		return model;
 	}
 
@@ -96,6 +204,23 @@ namespace scone
 		return CreateModelFromParams( params );
 	}
 
+	ModelUP ModelObjective::CreateModelFromBindingPlan( const SearchPoint& point ) const
+	{
+		if ( auto plan = std::atomic_load( &binding_plan_ ) )
+		{
+			// replay existing plan
+			BindingSearchPoint params( point, *plan );
+			return CreateModelFromParams( params );
+		}
+
+		// record new plan
+		auto plan = std::make_shared<ParamBindingPlan>();
+		BindingSearchPoint params( point, *plan );
+		auto model = CreateModelFromParams( params );
+		std::atomic_store( &binding_plan_, std::shared_ptr<const ParamBindingPlan>( std::move( plan ) ) );
+		return model;
+	}
+
 	std::vector<path> ModelObjective::WriteResults( const path& file_base )
 	{
 		// this does not work because we don't have a model member in Objective
@@ -11,6 +11,11 @@
 #include "scone/optimization/Objective.h"
 #include "scone/model/Model.h"
 #include "scone/core/Factories.h"
+#include "ParamBindingPlan.h"
+#include "EvaluationCache.h"
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace scone
 {
@@ -21,9 +26,32 @@ namespace scone
 		ModelObjective( const PropNode& props, const path& find_file_folder );
 		virtual ~ModelObjective() = default;
 
+		/// ADVANCED: record parameter lookups of the first model construction and replay them by index for subsequent evaluations; default = 0.
+		bool use_param_binding_plan;
+
+		/// ADVANCED: keep idle models in a pool and re-parameterize them for each evaluation,
+		/// requires a Controller and / or Measure defined outside the Model, and a Model without free parameters.
+		/// The pool holds at most one model per concurrent evaluation. Cannot be combined with use_model_arena; default = 0.
+		bool reuse_models;
+
+		/// ADVANCED: store the fitness of each evaluation in a persistent cache and return cached results for
+		/// identical parameters, scenario, external resources and SCONE version; default = 0.
+		bool use_evaluation_cache;
+
+		/// File used for use_evaluation_cache; default = evaluation_cache.txt in the results folder.
+		path evaluation_cache_file;
+
+		/// ADVANCED: allocate the sensors, controllers, reflexes, neurons and measures of each evaluation model
+		/// contiguously in a per-model arena that is released at once when the model is destroyed; default = 0.
+		bool use_model_arena;
+
 		virtual result<fitness_t> evaluate( const SearchPoint& point, const xo::stop_token& st ) const override;
 		virtual result<fitness_t> EvaluateModel( Model& m, const xo::stop_token& st ) const;
 
+		/// Evaluate model m that was created from point, used by evaluate(); calls EvaluateModel() by default.
+		/// Objectives that require additional models for the same point can override this.
+		virtual result<fitness_t> EvaluateModelForPoint( Model& m, const SearchPoint& point, const xo::stop_token& st ) const;
+
 		virtual void AdvanceSimulationTo( Model& m, TimeInSeconds t ) const = 0;
 		virtual TimeInSeconds GetDuration() const = 0;
 		virtual fitness_t GetResult( Model& m ) const = 0;
@@ -31,12 +59,21 @@ namespace scone
 
 		virtual ModelUP CreateModelFromParams( Params& point ) const;
 		ModelUP CreateModelFromParFile( const path& parfile ) const;
+		ModelUP CreateModelFromBindingPlan( const SearchPoint& point ) const;
+		bool CanReuseModels() const { return reuse_models && model_param_count_ == 0 && ( controller_factory_props_ || measure_factory_props_ ); }
 
 		virtual std::vector<path> WriteResults( const path& file_base ) override;
 
 		const Model& GetModel() const { return *model_; }
 		Model& GetModel() { return *model_; }
 
+		/// Get the sum of the performance counters of all evaluations since the previous call, and reset them.
+		PerfCounters TakePerfCounters() const;
+
+		/// Total simulated time of all evaluated models, used to measure throughput independent of the simulation duration.
+		/// Evaluations found in the evaluation cache are not simulated and do not add to this time.
+		TimeInSeconds GetSimulatedTime() const;
+
 	protected:
 		PropNode objective_pn_;
 		FactoryProps model_factory_props_;
@@ -47,6 +84,25 @@ namespace scone
 		String signature_; // cached variable, because we need to create a model to get the signature
 		virtual String GetClassSignature() const override { return signature_; }
 		TimeInSeconds evaluation_step_size_;
+		mutable std::shared_ptr<const ParamBindingPlan> binding_plan_;
+		size_t model_param_count_; // number of parameters used by the model, excluding external controller and measure
+		std::shared_ptr<EvaluationCache> evaluation_cache_;
+		EvaluationCache::key_t scenario_key_; // key for use_evaluation_cache
+
+		// add performance counters of models that are evaluated outside EvaluateModelForPoint()
+		void AddPerfCounters( const PerfCounters& pc ) const;
+
+	private:
+		result<fitness_t> EvaluateUncached( const SearchPoint& point, const xo::stop_token& st ) const;
+		result<fitness_t> EvaluateAndCount( Model& m, const SearchPoint& point, const xo::stop_token& st ) const;
+
+		static constexpr size_t max_reusable_models = 64;
+		mutable std::mutex reusable_models_mutex_;
+		mutable std::vector< ModelUP > reusable_models_; // idle models that are checked out per evaluation, see reuse_models
+
+		mutable std::mutex perf_counters_mutex_;
+		mutable PerfCounters perf_counters_; // aggregated over evaluations, see TakePerfCounters()
+		mutable TimeInSeconds simulated_time_; // never reset, see GetSimulatedTime()
 	};
 
 	/// Create ModelObjective from a PropNode
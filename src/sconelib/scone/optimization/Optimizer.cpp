@@ -25,6 +25,9 @@
 #include "xo/system/error_code.h"
 #include "xo/thread/thread_priority.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <sstream>
 #include <limits>
@@ -32,7 +35,80 @@
 
 namespace scone
 {
-	std::mutex g_status_output_mutex;
+	// Writes status messages to std::cout from a dedicated thread, which is stopped when the last owning Optimizer is destroyed.
+	// Producers push to a lock-free queue and only lock mutex_ to wake an idle writer; formatting and console I/O happen on the writer thread.
+	class StatusConsoleWriter
+	{
+	public:
+		StatusConsoleWriter() : pending_( 0 ), stop_( false ), thread_( [this]() { Run(); } ) {}
+		~StatusConsoleWriter() {
+			{
+				std::scoped_lock lock( mutex_ );
+				stop_ = true;
+			}
+			wake_.notify_one();
+			thread_.join();
+		}
+
+		void Push( PropNode&& pn ) {
+			// count before pushing, so the writer never takes more messages than are pending
+			const bool was_idle = pending_.fetch_add( 1 ) == 0;
+			queue_.push( std::move( pn ) );
+			if ( was_idle ) {
+				// the writer checks pending_ under mutex_ before waiting, locking here prevents a lost wake-up
+				{ std::scoped_lock lock( mutex_ ); }
+				wake_.notify_one();
+			}
+		}
+
+		void Flush() {
+			std::unique_lock lock( mutex_ );
+			flushed_.wait( lock, [this]() { return pending_ == 0; } );
+		}
+
+	private:
+		void Run() {
+			std::unique_lock lock( mutex_ );
+			while ( true ) {
+				wake_.wait( lock, [this]() { return pending_ > 0 || stop_; } );
+				if ( pending_ == 0 )
+					break; // stop_ is set and all messages are written
+
+				// format and write without holding the lock
+				lock.unlock();
+				auto count = Drain();
+				lock.lock();
+
+				// pending_ only reaches zero here, under mutex_, which is what Flush() waits for
+				if ( pending_.fetch_sub( count ) == count )
+					flushed_.notify_all();
+				else if ( count == 0 )
+					std::this_thread::yield(); // a producer has counted its message but not yet pushed it
+			}
+		}
+
+		size_t Drain() {
+			size_t count = 0;
+			PropNode pn;
+			std::ostringstream str;
+			while ( queue_.try_pop( pn ) ) {
+				xo::error_code ec;
+				str << '*' << xo::prop_node_serializer_zml_concise( pn, &ec ) << '\n';
+				++count;
+			}
+			if ( count > 0 )
+				std::cout << str.str() << std::flush;
+			return count;
+		}
+
+		MpscQueue<PropNode> queue_;
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		std::condition_variable flushed_;
+		std::atomic<size_t> pending_; // messages pushed but not yet written
+		bool stop_; // guarded by mutex_
+		std::thread thread_;
+	};
 
 	Optimizer::Optimizer( const PropNode& props, const PropNode& scenario_pn, const path& scenario_dir ) :
 		HasSignature( props ),
@@ -113,6 +189,7 @@ namespace scone
 			log::warning( "Terminating Optimization" );
 			Terminate();
 		}
+		FlushStatusOutput();
 	}
 
 	const path& Optimizer::GetOutputFolder() const
@@ -131,36 +208,38 @@ namespace scone
 	void Optimizer::OutputStatus( PropNode&& pn ) const
 	{
 		if ( output_mode_ == status_console_output )
-		{
-			xo::error_code ec;
-			std::ostringstream str;
-			str << xo::prop_node_serializer_zml_concise( pn, &ec );
-			auto message = "*" + str.str();
-			g_status_output_mutex.lock();
-			std::cout << message << std::endl;
-			g_status_output_mutex.unlock();
-		}
+			status_writer_->Push( std::move( pn ) );
 		else if ( output_mode_ == status_queue_output )
-		{
-			auto lock = std::scoped_lock( status_queue_mutex_ );
-			status_queue_.push_back( std::move( pn ) );
-		}
+			status_queue_.push( std::move( pn ) );
 	}
 
 	std::deque<PropNode> Optimizer::GetStatusMessages() const
 	{
 		std::deque<PropNode> results;
-		{
-			auto lock = std::scoped_lock( status_queue_mutex_ );
-			if ( !status_queue_.empty() )
-			{
-				results = std::move( status_queue_ );
-				status_queue_.clear();
-			}
-		}
+		auto lock = std::scoped_lock( status_consumer_mutex_ );
+		for ( PropNode pn; status_queue_.try_pop( pn ); )
+			results.push_back( std::move( pn ) );
 		return results;
 	}
 
+	void Optimizer::SetOutputMode( OutputMode m )
+	{
+		output_mode_ = m;
+		if ( output_mode_ == status_console_output && !status_writer_ )
+			status_writer_ = std::make_shared<StatusConsoleWriter>();
+	}
+
+	void Optimizer::ShareStatusOutput( const Optimizer& o )
+	{
+		status_writer_ = o.status_writer_;
+	}
+
+	void Optimizer::FlushStatusOutput() const
+	{
+		if ( status_writer_ )
+			status_writer_->Flush();
+	}
+
 	String Optimizer::GetClassSignature() const
 	{
 		String s = GetObjective().GetSignature();
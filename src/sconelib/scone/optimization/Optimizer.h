@@ -12,15 +12,20 @@
 #include "Params.h"
 #include "scone/core/HasSignature.h"
 #include "scone/core/types.h"
+#include "scone/core/MpscQueue.h"
 #include "xo/system/log_sink.h"
+#include "spot/evaluator.h"
 #include <deque>
 #include <mutex>
 #include "ParInitSettings.h"
 #include <thread>
 #include <future>
+#include <memory>
 
 namespace scone
 {
+	class StatusConsoleWriter;
+
 	/// Base class for Optimizers.
 	class SCONE_API Optimizer : public HasSignature
 	{
@@ -101,12 +106,14 @@ namespace scone
 
 		// #todo: move this to reporter
 		enum OutputMode { no_output, console_output, status_console_output, status_queue_output };
-		virtual void SetOutputMode( OutputMode m ) { output_mode_ = m; }
+		virtual void SetOutputMode( OutputMode m );
+		void ShareStatusOutput( const Optimizer& o ); // write console status output through the same writer as o
 		bool GetStatusOutput() const { return output_mode_ == status_console_output || output_mode_ == status_queue_output; }
 		PropNode GetStatusPropNode() const;
 		void OutputStatus( PropNode&& pn ) const;
 		template< typename T > void OutputStatus( const String& key, const T& value ) const;
 		std::deque<PropNode> GetStatusMessages() const;
+		void FlushStatusOutput() const;
 
 		const String& id() const { return id_; }
 
@@ -129,8 +136,10 @@ namespace scone
 		virtual void RunImpl() = 0;
 
 		OutputMode output_mode_;
-		mutable std::deque<PropNode> status_queue_; // #todo: move this to reporter
-		mutable std::mutex status_queue_mutex_;
+		mutable MpscQueue<PropNode> status_queue_; // #todo: move this to reporter
+		mutable std::mutex status_consumer_mutex_; // only guards consumers, producers never block
+		s_ptr<spot::evaluator> evaluator_; // evaluator owned by this optimizer, or shared with its parent, see GetSpotEvaluator()
+		std::shared_ptr<StatusConsoleWriter> status_writer_; // used for status_console_output, shared with child optimizers
 
 		mutable path output_folder_;
 		mutable String id_;
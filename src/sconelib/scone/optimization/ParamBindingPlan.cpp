@@ -0,0 +1,57 @@
+/*
+** ParamBindingPlan.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "ParamBindingPlan.h"
+
+namespace scone
+{
+	BindingSearchPoint::BindingSearchPoint( const SearchPoint& sp, ParamBindingPlan& record_plan ) :
+		SearchPoint( sp ),
+		record_plan_( &record_plan ),
+		replay_plan_( nullptr ),
+		replay_count_( 0 )
+	{
+		record_plan_->bindings.clear();
+	}
+
+	BindingSearchPoint::BindingSearchPoint( const SearchPoint& sp, const ParamBindingPlan& replay_plan ) :
+		SearchPoint( sp ),
+		record_plan_( nullptr ),
+		replay_plan_( &replay_plan ),
+		replay_count_( 0 )
+	{}
+
+	OptionalPar BindingSearchPoint::try_get( const String& full_name ) const
+	{
+		if ( replay_plan_ )
+		{
+			// replay by index, as long as the lookups match the plan
+			if ( replay_count_ < replay_plan_->bindings.size() ) {
+				const auto& b = replay_plan_->bindings[replay_count_];
+				if ( b.name == full_name ) {
+					++replay_count_;
+					return b.index != no_index ? OptionalPar( values()[b.index] ) : b.fixed_value;
+				}
+			}
+			replay_plan_ = nullptr; // mismatch, use name lookup from here on
+		}
+		else if ( record_plan_ )
+		{
+			auto index = info().find_index( full_name );
+			if ( index != no_index ) {
+				record_plan_->bindings.push_back( { full_name, index, OptionalPar() } );
+				return values()[index];
+			}
+			auto value = SearchPoint::try_get( full_name );
+			record_plan_->bindings.push_back( { full_name, no_index, value } );
+			return value;
+		}
+
+		return SearchPoint::try_get( full_name );
+	}
+}
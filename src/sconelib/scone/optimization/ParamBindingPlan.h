@@ -0,0 +1,54 @@
+/*
+** ParamBindingPlan.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "Params.h"
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include <vector>
+
+namespace scone
+{
+	/// Ordered list of parameter lookups performed during model construction.
+	/// Subsequent constructions for the same objective perform the same lookups in the same order,
+	/// which allows parameters to be resolved by index instead of by name.
+	/// Full names are still composed by spot::par_io before try_get() is called; replay avoids the search
+	/// through all parameter names, and only compares the name with the recorded one to detect a different path.
+	struct SCONE_API ParamBindingPlan
+	{
+		struct Binding {
+			String name; // full parameter name, used to verify the replay
+			index_t index; // index in the SearchPoint, or no_index for fixed or unknown parameters
+			OptionalPar fixed_value; // value in case index == no_index
+		};
+		std::vector<Binding> bindings;
+	};
+
+	/// SearchPoint that records a ParamBindingPlan, or resolves parameters using an existing plan.
+	/// When a lookup does not match the plan, the remaining lookups fall back to name-based lookup.
+	class SCONE_API BindingSearchPoint : public SearchPoint
+	{
+	public:
+		// record lookups into plan
+		BindingSearchPoint( const SearchPoint& sp, ParamBindingPlan& record_plan );
+		// replay lookups from plan
+		BindingSearchPoint( const SearchPoint& sp, const ParamBindingPlan& replay_plan );
+
+		virtual OptionalPar try_get( const String& full_name ) const override;
+
+		// number of lookups that matched the replay plan
+		size_t GetReplayCount() const { return replay_count_; }
+		bool IsReplayValid() const { return replay_plan_ != nullptr; }
+
+	private:
+		ParamBindingPlan* record_plan_;
+		mutable const ParamBindingPlan* replay_plan_;
+		mutable size_t replay_count_;
+	};
+}
@@ -0,0 +1,476 @@
+/*
+** ProcessEvaluator.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "ProcessEvaluator.h"
+
+#include "Objective.h"
+#include "Optimizer.h"
+#include "opt_tools.h"
+#include "scone/core/Exception.h"
+#include "scone/core/Factories.h"
+#include "scone/core/Log.h"
+#include "xo/filesystem/filesystem.h"
+#include "xo/string/string_tools.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+
+#ifndef _WIN32
+#	include <fcntl.h>
+#	include <poll.h>
+#	include <signal.h>
+#	include <spawn.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#	ifdef __APPLE__
+#		include <crt_externs.h>
+#		define environ ( *_NSGetEnviron() )
+#	else
+extern char** environ;
+#	endif
+#endif
+
+namespace scone
+{
+	// parse floating point value, including inf and nan
+	static double ParseValue( std::istream& str ) {
+		String token;
+		str >> token;
+		return std::strtod( token.c_str(), nullptr );
+	}
+
+	ProcessEvaluator::ProcessEvaluator( const ProcessEvaluatorSettings& settings ) :
+		settings_( settings ),
+		worker_count_( 0 ),
+		next_task_id_( 0 )
+	{}
+
+	ProcessEvaluator::~ProcessEvaluator()
+	{
+		StopWorkers();
+	}
+
+	void ProcessEvaluator::SetSettings( const ProcessEvaluatorSettings& settings )
+	{
+		auto lock = std::scoped_lock( mutex_ );
+		settings_ = settings; // claimed workers with a different command are restarted when they are claimed again
+	}
+
+	size_t ProcessEvaluator::AcquireWorkers( std::vector<WorkerUP>& workers, size_t max_count, bool wait ) const
+	{
+		auto lock = std::unique_lock( mutex_ );
+		const auto max_workers = std::max<size_t>( 1, settings_.worker_count );
+		if ( wait )
+			worker_released_.wait( lock, [&]() { return !idle_workers_.empty() || worker_count_ < max_workers; } );
+		size_t count = 0;
+		for ( ; count < max_count && !idle_workers_.empty(); ++count ) {
+			workers.push_back( std::move( idle_workers_.back() ) );
+			idle_workers_.pop_back();
+		}
+		for ( ; count < max_count && worker_count_ < max_workers; ++count ) {
+			workers.push_back( std::make_unique<Worker>() ); // started by the caller
+			++worker_count_;
+		}
+		return count;
+	}
+
+	void ProcessEvaluator::ReleaseWorkers( std::vector<WorkerUP>& workers ) const
+	{
+		{
+			auto lock = std::scoped_lock( mutex_ );
+			for ( auto& w : workers ) {
+				if ( w->pid > 0 && worker_count_ <= std::max<size_t>( 1, settings_.worker_count ) )
+					idle_workers_.push_back( std::move( w ) );
+				else {
+					StopWorker( *w );
+					--worker_count_;
+				}
+			}
+		}
+		workers.clear();
+		worker_released_.notify_all();
+	}
+
+	void ProcessEvaluator::StopWorkers() const
+	{
+		auto lock = std::scoped_lock( mutex_ );
+		for ( auto& w : idle_workers_ )
+			StopWorker( *w );
+		worker_count_ -= idle_workers_.size();
+		idle_workers_.clear();
+	}
+
+#ifndef _WIN32
+	std::vector< spot::result<spot::fitness_t> > ProcessEvaluator::evaluate( const spot::objective& o, const spot::search_point_vec& point_vec, const xo::stop_token& st, spot::priority_t prio ) const
+	{
+		// workers are started with the config.scone in the optimization output folder
+		auto* so = dynamic_cast<const Objective*>( &o );
+		SCONE_ERROR_IF( !so, "ProcessEvaluator requires a SCONE Objective" );
+		auto scenario_file = so->GetExternalResourceDir() / "config.scone";
+		SCONE_ERROR_IF( !xo::file_exists( scenario_file ), "ProcessEvaluator could not find " + scenario_file.str() );
+
+		ProcessEvaluatorSettings settings;
+		{
+			auto lock = std::scoped_lock( mutex_ );
+			settings = settings_;
+		}
+		const auto command = settings.worker_command.empty() ? GetApplicationFolder() / "sconecmd" : settings.worker_command;
+
+		const size_t n = point_vec.size();
+		const size_t first_task = next_task_id_.fetch_add( n );
+		auto is_current_task = [&]( size_t task_id ) { return task_id != no_index && task_id >= first_task && task_id < first_task + n; };
+
+		std::vector< spot::result<spot::fitness_t> > results( n, xo::error_message( "Not evaluated" ) );
+		std::vector<bool> done( n, false );
+		std::vector<size_t> attempts( n, 0 );
+		std::vector<size_t> running( n, 0 );
+		std::deque<index_t> queue;
+		for ( index_t idx = 0; idx < n; ++idx )
+			queue.push_back( idx );
+		size_t remaining = n;
+		double total_task_duration = 0.0;
+		size_t completed_tasks = 0;
+
+		// claimed workers are returned to the idle workers when leaving this function, also after an exception
+		std::vector<WorkerUP> workers;
+		struct ReleaseOnExit {
+			const ProcessEvaluator& pe;
+			std::vector<WorkerUP>& workers;
+			~ReleaseOnExit() { pe.ReleaseWorkers( workers ); }
+		} release_on_exit{ *this, workers };
+
+		auto claim_workers = [&]( size_t max_count, bool wait ) {
+			auto count = AcquireWorkers( workers, max_count, wait );
+			for ( auto widx = workers.size() - count; widx < workers.size(); ++widx ) {
+				auto& w = *workers[ widx ];
+				w.task = no_index; // results of previous batches are ignored
+				if ( w.pid <= 0 || w.command != command || w.scenario_file != scenario_file ) {
+					StopWorker( w );
+					StartWorker( w, command, scenario_file, settings.task_timeout );
+				}
+			}
+		};
+
+		auto complete_task = [&]( Worker& w, size_t task_id, spot::result<spot::fitness_t> r ) {
+			if ( w.task != task_id )
+				return; // unexpected message
+			w.task = no_index;
+			w.start_failures = 0;
+			if ( !is_current_task( task_id ) )
+				return; // result from a previous batch
+			auto idx = task_id - first_task;
+			--running[ idx ];
+			if ( !done[ idx ] ) {
+				results[ idx ] = std::move( r );
+				done[ idx ] = true;
+				--remaining;
+				total_task_duration += std::chrono::duration<double>( clock::now() - w.task_start ).count();
+				++completed_tasks;
+			}
+		};
+
+		// workers that fail without a started search point are restarted after a delay, and given up after max_retries
+		size_t batch_start_failures = 0;
+		String start_failure_reason;
+		auto restart_worker = [&]( Worker& w, const String& reason, bool task_started = true ) {
+			const bool task_failed = task_started && w.task != no_index;
+			auto start_failures = w.start_failures + ( task_failed ? 0 : 1 );
+			if ( start_failures > settings.max_retries )
+				log::error( "Worker process ", w.pid, " failed ", start_failures, " times without completing a search point: ", reason );
+			else log::warning( "Restarting worker process ", w.pid, ": ", reason );
+			if ( is_current_task( w.task ) ) {
+				auto idx = w.task - first_task;
+				--running[ idx ];
+				if ( !done[ idx ] && running[ idx ] == 0 ) {
+					if ( task_started && ++attempts[ idx ] > settings.max_retries ) {
+						results[ idx ] = xo::error_message( "Worker process failed: " + reason );
+						done[ idx ] = true;
+						--remaining;
+					}
+					else queue.push_front( idx );
+				}
+			}
+			StopWorker( w );
+			w.start_failures = start_failures;
+			if ( !task_failed ) {
+				++batch_start_failures;
+				start_failure_reason = reason;
+			}
+			if ( start_failures == 0 )
+				StartWorker( w, command, scenario_file, settings.task_timeout );
+			else w.restart_time = clock::now() + std::chrono::duration_cast<clock::duration>(
+				std::chrono::duration<double>( std::min( 0.1 * std::pow( 2.0, double( start_failures - 1 ) ), 5.0 ) ) );
+		};
+		auto is_given_up = [&]( const WorkerUP& w ) { return w->start_failures > settings.max_retries; };
+
+		// wait until at least one worker is available
+		claim_workers( n, true );
+
+		while ( remaining > 0 )
+		{
+			if ( st.stop_requested() ) {
+				// restart busy workers, their results are no longer needed
+				for ( auto& w : workers ) {
+					if ( w->task != no_index ) {
+						StopWorker( *w );
+						StartWorker( *w, command, scenario_file, settings.task_timeout );
+					}
+				}
+				for ( index_t idx = 0; idx < n; ++idx )
+					if ( !done[ idx ] )
+						results[ idx ] = xo::error_message( "Optimization canceled" );
+				break;
+			}
+
+			// claim additional workers that have become available
+			if ( !queue.empty() )
+				claim_workers( queue.size(), false );
+
+			// fail if no worker can be started
+			SCONE_ERROR_IF( std::all_of( workers.begin(), workers.end(), is_given_up )
+				|| batch_start_failures > ( settings.max_retries + 1 ) * std::max<size_t>( 1, settings.worker_count ),
+				"Could not start worker process " + command.str() + ": " + start_failure_reason + "; see the worker log output for details" );
+
+			// start workers that were stopped after a failure
+			auto now = clock::now();
+			for ( auto& w : workers )
+				if ( w->pid <= 0 && !is_given_up( w ) && now >= w->restart_time )
+					StartWorker( *w, command, scenario_file, settings.task_timeout );
+
+			// dispatch search points to idle workers
+			for ( auto& w : workers ) {
+				if ( w->dim == no_index || w->task != no_index )
+					continue;
+				index_t idx = no_index;
+				if ( !queue.empty() ) {
+					idx = queue.front();
+					queue.pop_front();
+				}
+				else if ( completed_tasks > 0 ) {
+					// duplicate the longest running search point if it takes much longer than average
+					auto straggler_time = 2.0 * total_task_duration / completed_tasks;
+					auto oldest_start = now;
+					for ( auto& ow : workers ) {
+						if ( is_current_task( ow->task ) && running[ ow->task - first_task ] == 1 && ow->task_start < oldest_start
+							&& std::chrono::duration<double>( now - ow->task_start ).count() > straggler_time ) {
+							oldest_start = ow->task_start;
+							idx = ow->task - first_task;
+						}
+					}
+				}
+				if ( idx == no_index )
+					break;
+
+				++running[ idx ];
+				w->task = first_task + idx;
+				w->task_start = now;
+				w->deadline = now + std::chrono::duration_cast<clock::duration>( std::chrono::duration<double>( settings.task_timeout ) );
+				if ( !SendTask( *w, w->task, point_vec[ idx ] ) )
+					restart_worker( *w, "could not send search point", false ); // worker exited before receiving the task
+			}
+
+			// wait for messages
+			std::vector<pollfd> fds;
+			for ( auto& w : workers )
+				fds.push_back( pollfd{ w->output_fd, POLLIN, 0 } );
+			::poll( fds.data(), fds.size(), 100 );
+
+			now = clock::now();
+			for ( index_t widx = 0; widx < workers.size(); ++widx ) {
+				auto& w = *workers[ widx ];
+				if ( fds[ widx ].revents & ( POLLIN | POLLHUP | POLLERR ) ) {
+					char buf[ 4096 ];
+					auto count = ::read( w.output_fd, buf, sizeof( buf ) );
+					if ( count <= 0 ) {
+						restart_worker( w, "process exited" );
+						continue;
+					}
+					w.buffer.append( buf, count );
+					for ( auto eol = w.buffer.find( '\n' ); eol != String::npos; eol = w.buffer.find( '\n' ) ) {
+						std::istringstream str( w.buffer.substr( 0, eol ) );
+						w.buffer.erase( 0, eol + 1 );
+						String msg;
+						str >> msg;
+						if ( msg == "@result" ) {
+							size_t task_id = no_index;
+							str >> task_id;
+							complete_task( w, task_id, ParseValue( str ) );
+						}
+						else if ( msg == "@error" ) {
+							size_t task_id = no_index;
+							String error_msg;
+							str >> task_id;
+							std::getline( str >> std::ws, error_msg );
+							complete_task( w, task_id, xo::error_message( error_msg ) );
+						}
+						else if ( msg == "@ready" ) {
+							size_t dim = no_index;
+							str >> dim;
+							if ( dim != o.info().dim() ) {
+								StopWorker( w );
+								SCONE_ERROR( xo::stringf( "Worker process for %s has %zu parameters instead of %zu",
+									scenario_file.str().c_str(), dim, o.info().dim() ) );
+							}
+							w.dim = dim;
+						}
+						// all other lines are ignored
+					}
+				}
+				else if ( settings.task_timeout > 0 && w.pid > 0 && ( w.dim == no_index || w.task != no_index ) && now > w.deadline )
+					restart_worker( w, w.dim == no_index ? "no response after start" : "evaluation timeout" );
+			}
+		}
+
+		return results;
+	}
+
+	// create a pipe that is not inherited by child processes; the dup2 of the worker's stdin / stdout clears this flag
+	static void CreatePipe( int fds[ 2 ] ) {
+		SCONE_ERROR_IF( ::pipe( fds ) != 0, "Could not create pipe for worker process" );
+		::fcntl( fds[ 0 ], F_SETFD, FD_CLOEXEC );
+		::fcntl( fds[ 1 ], F_SETFD, FD_CLOEXEC );
+	}
+
+	void ProcessEvaluator::StartWorker( Worker& w, const path& command, const path& scenario_file, double timeout ) const
+	{
+		::signal( SIGPIPE, SIG_IGN ); // failed writes to workers are handled by restarting them
+
+		int to_worker[ 2 ], from_worker[ 2 ];
+		CreatePipe( to_worker );
+		CreatePipe( from_worker );
+
+		// posix_spawn is used instead of fork(), which is unsafe in a multi-threaded process
+		posix_spawn_file_actions_t actions;
+		::posix_spawn_file_actions_init( &actions );
+		::posix_spawn_file_actions_adddup2( &actions, to_worker[ 0 ], STDIN_FILENO );
+		::posix_spawn_file_actions_adddup2( &actions, from_worker[ 1 ], STDOUT_FILENO );
+		const String command_str = command.str();
+		const String scenario_str = scenario_file.str();
+		const char* argv[] = { command_str.c_str(), "--worker", scenario_str.c_str(), "-l", "4", nullptr };
+		pid_t pid = -1;
+		auto err = ::posix_spawnp( &pid, command_str.c_str(), &actions, nullptr, const_cast<char* const*>( argv ), environ );
+		::posix_spawn_file_actions_destroy( &actions );
+
+		::close( to_worker[ 0 ] );
+		::close( from_worker[ 1 ] );
+		if ( err != 0 ) {
+			::close( to_worker[ 1 ] );
+			::close( from_worker[ 0 ] );
+			SCONE_ERROR( "Could not start worker process " + command_str + ": " + std::strerror( err ) );
+		}
+
+		w.pid = pid;
+		w.input_fd = to_worker[ 1 ];
+		w.output_fd = from_worker[ 0 ];
+		w.command = command;
+		w.scenario_file = scenario_file;
+		w.buffer.clear();
+		w.dim = no_index;
+		w.task = no_index;
+		w.deadline = clock::now() + std::chrono::duration_cast<clock::duration>( std::chrono::duration<double>( timeout ) );
+	}
+
+	void ProcessEvaluator::StopWorker( Worker& w ) const
+	{
+		if ( w.pid > 0 ) {
+			::kill( w.pid, SIGKILL );
+			::close( w.input_fd );
+			::close( w.output_fd );
+			::waitpid( w.pid, nullptr, 0 );
+		}
+		w = Worker();
+	}
+
+	bool ProcessEvaluator::SendTask( Worker& w, size_t task_id, const spot::search_point& sp ) const
+	{
+		const auto& values = sp.values();
+		String msg = xo::stringf( "@eval %zu %zu", task_id, values.size() );
+		for ( const auto& v : values )
+			msg += xo::stringf( " %.17g", v );
+		msg += '\n';
+
+		for ( size_t written = 0; written < msg.size(); ) {
+			auto count = ::write( w.input_fd, msg.data() + written, msg.size() - written );
+			if ( count <= 0 )
+				return false;
+			written += count;
+		}
+		return true;
+	}
+#else
+	std::vector< spot::result<spot::fitness_t> > ProcessEvaluator::evaluate( const spot::objective& o, const spot::search_point_vec& point_vec, const xo::stop_token& st, spot::priority_t prio ) const
+	{
+		SCONE_THROW( "ProcessEvaluator is not supported on this platform" );
+	}
+	void ProcessEvaluator::StartWorker( Worker& w, const path& command, const path& scenario_file, double timeout ) const {}
+	void ProcessEvaluator::StopWorker( Worker& w ) const {}
+	bool ProcessEvaluator::SendTask( Worker& w, size_t task_id, const spot::search_point& sp ) const { return false; }
+#endif
+
+	int RunEvaluationWorker( const path& scenario_file )
+	{
+#ifndef _WIN32
+		// protocol messages are written to the original stdout, all other output (including logs) goes to stderr
+		std::cout.flush();
+		const int protocol_fd = ::dup( STDOUT_FILENO );
+		::dup2( STDERR_FILENO, STDOUT_FILENO );
+		auto write_line = [&]( String line ) {
+			std::replace( line.begin(), line.end(), '\n', ' ' ); // messages must be on a single line
+			line += '\n';
+			for ( size_t written = 0; written < line.size(); ) {
+				auto count = ::write( protocol_fd, line.data() + written, line.size() - written );
+				if ( count <= 0 )
+					return;
+				written += count;
+			}
+		};
+#else
+		auto write_line = [&]( String line ) {
+			std::replace( line.begin(), line.end(), '\n', ' ' ); // messages must be on a single line
+			std::cout << line << '\n' << std::flush;
+		};
+#endif
+
+		auto scenario_pn = LoadScenario( scenario_file );
+		auto opt = CreateOptimizer( scenario_pn, scenario_file.parent_path() );
+		auto& obj = opt->GetObjective();
+
+		write_line( xo::stringf( "@ready %zu", obj.info().dim() ) );
+		for ( String line; std::getline( std::cin, line ); ) {
+			std::istringstream str( line );
+			String msg;
+			str >> msg;
+			if ( msg == "@eval" ) {
+				size_t task_id = no_index, n = 0;
+				str >> task_id >> n;
+				try {
+					SCONE_ERROR_IF( n != obj.info().dim(), xo::stringf( "Invalid number of parameters: %zu != %zu", n, obj.info().dim() ) );
+					std::vector<ParValue> values( n );
+					for ( auto& v : values )
+						v = ParseValue( str );
+					SearchPoint sp( obj.info(), values );
+					auto r = obj.evaluate( sp, xo::stop_token() );
+					if ( r )
+						write_line( xo::stringf( "@result %zu %.17g", task_id, r.value() ) );
+					else write_line( xo::stringf( "@error %zu ", task_id ) + r.error().message() );
+				}
+				catch ( std::exception& e ) {
+					write_line( xo::stringf( "@error %zu ", task_id ) + e.what() );
+				}
+			}
+			else if ( msg == "@quit" )
+				break;
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,93 @@
+/*
+** ProcessEvaluator.h
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#pragma once
+
+#include "scone/core/platform.h"
+#include "scone/core/types.h"
+#include "spot/evaluator.h"
+#include "xo/filesystem/path.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace scone
+{
+	/// Settings for ProcessEvaluator.
+	struct ProcessEvaluatorSettings
+	{
+		path worker_command; // sconecmd executable used for workers
+		size_t worker_count = 4; // number of worker processes
+		double task_timeout = 300.0; // seconds a worker may take to start or evaluate a search point before it is restarted, 0 = no limit
+		size_t max_retries = 2; // number of times a search point is retried, or a worker is restarted without completing a search point, after a failure
+	};
+
+	/// Evaluator that distributes search points over local sconecmd worker processes.
+	/// Workers are started with "sconecmd --worker <config.scone>" and communicate through stdin / stdout
+	/// using a line-based protocol. Lines starting with '@' are protocol messages, all other lines are ignored:
+	///   coordinator -> worker: "@eval <id> <n> <value_1> ... <value_n>", "@quit"
+	///   worker -> coordinator: "@ready <dim>", "@result <id> <fitness>", "@error <id> <message>"
+	/// Workers write their log output to stderr. Search points are only sent after a worker has reported
+	/// the same number of parameters as the objective.
+	/// Workers keep their objective (and models, if reuse_models is set) alive between requests.
+	/// Crashed workers, and workers that exceed task_timeout, are restarted and their search points are retried;
+	/// idle workers duplicate the longest running search point to reduce straggler delays.
+	/// Workers that fail before completing a search point are restarted with increasing delays, and are given up
+	/// after max_retries; evaluate() throws if all its workers are given up.
+	/// Concurrent calls to evaluate() share the worker processes: each call claims idle workers for its batch.
+	/// Currently only available on POSIX systems.
+	class SCONE_API ProcessEvaluator : public spot::evaluator
+	{
+	public:
+		ProcessEvaluator( const ProcessEvaluatorSettings& settings );
+		virtual ~ProcessEvaluator();
+
+		virtual std::vector< spot::result<spot::fitness_t> > evaluate( const spot::objective& o, const spot::search_point_vec& point_vec, const xo::stop_token& st, spot::priority_t prio ) const override;
+
+		void SetSettings( const ProcessEvaluatorSettings& settings );
+
+	private:
+		using clock = std::chrono::steady_clock;
+		struct Worker {
+			int pid = -1;
+			int input_fd = -1; // worker stdin
+			int output_fd = -1; // worker stdout
+			path command;
+			path scenario_file;
+			String buffer;
+			size_t dim = no_index; // number of parameters reported by @ready, no_index until the worker is ready
+			size_t task = no_index;
+			clock::time_point task_start;
+			clock::time_point deadline; // worker is restarted if it is not ready or still busy after this time
+			size_t start_failures = 0; // failures since the last completed search point, see max_retries
+			clock::time_point restart_time; // a stopped worker is started again after this time
+		};
+		using WorkerUP = std::unique_ptr<Worker>;
+
+		size_t AcquireWorkers( std::vector<WorkerUP>& workers, size_t max_count, bool wait ) const;
+		void ReleaseWorkers( std::vector<WorkerUP>& workers ) const;
+		void StartWorker( Worker& w, const path& command, const path& scenario_file, double timeout ) const;
+		void StopWorker( Worker& w ) const;
+		void StopWorkers() const;
+		bool SendTask( Worker& w, size_t task_id, const spot::search_point& sp ) const;
+
+		ProcessEvaluatorSettings settings_; // guarded by mutex_
+		mutable std::vector<WorkerUP> idle_workers_; // guarded by mutex_
+		mutable size_t worker_count_; // number of idle and claimed workers, guarded by mutex_
+		mutable std::atomic<size_t> next_task_id_;
+		mutable std::mutex mutex_; // only held while claiming or releasing workers
+		mutable std::condition_variable worker_released_;
+	};
+
+	/// Run an evaluation worker for scenario_file, reading requests from stdin and writing results to stdout.
+	/// This is used by sconecmd --worker.
+	SCONE_API int RunEvaluationWorker( const path& scenario_file );
+}
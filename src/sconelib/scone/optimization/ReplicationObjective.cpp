@@ -23,25 +23,7 @@
 #include "xo/container/prop_node_tools.h"
 
 #include <functional>
-
-#if defined( _MSC_VER )
-#include <charconv>
-inline void set_exact( scone::PropNode& pn, double value ) {
-	char buf[32];
-	auto res = std::to_chars( buf, buf + sizeof( buf ) - 1, value );
-	*res.ptr = '\0';
-	pn.set_value( buf );
-}
-inline double get_exact( scone::PropNode& pn ) {
-	double value;
-	const auto& str = pn.get_str();
-	std::from_chars( str.c_str(), str.c_str() + str.size(), value );
-	return value;
-}
-#else
-inline void set_exact( scone::PropNode& pn, double value ) { pn.set( value ); }
-inline double get_exact( scone::PropNode& pn ) { return pn.get<double>(); }
-#endif
+#include <algorithm>
 
 namespace scone
 {
@@ -126,47 +108,32 @@ namespace scone
 
 		const bool store_data = model.MustStoreCurrentFrame() || !model.GetData().IsEmpty();
 		const bool store_muscle_results = store_data;
-		const bool first_frame = !model.GetUserData().has_key( "RPL_err" );
 		const auto& muscles = model.GetMuscles();
 
 		// intermediate results are stored in the model
-		auto& mud = model.GetUserData();
-		if ( first_frame ) {
-			mud["RPL_err"] = 0;
-			mud["RPL_smp"] = 0;
-			mud["RPL_act"].add_children( muscles.size(), "", "0" );
-			if ( store_muscle_results )
-				for ( index_t idx = 0; idx < muscles.size(); ++idx )
-					mud["RPL_mus"][muscles[idx]->GetName() + ".error"] = 0;
+		auto& rs = model.GetSlot( state_slot_ );
+		if ( rs.activations.empty() ) {
+			rs.activations.resize( muscles.size(), 0.0 );
+			rs.muscle_errors.resize( muscles.size(), 0.0 );
+			rs.errors.resize( muscles.size() );
+			rs.has_muscle_errors = store_muscle_results; // muscle errors are only reported when data is stored
 		}
 
 		// intermediate values
-		std::vector<double> state_values( state_channels_.size() );
-		std::vector<double> errors( muscles.size(), 0.0 );
+		auto& activations = rs.activations;
+		auto& errors = rs.errors;
+		std::fill( errors.begin(), errors.end(), 0.0 );
 		double total_error = 0.0;
 		size_t samples = 0;
 
-		// initialize activations
-		auto& act_pn = mud["RPL_act"];
-		std::vector<double> activations( muscles.size() );
-		for ( index_t idx = 0; idx < muscles.size(); ++idx )
-			activations[idx] = get_exact( act_pn[idx] );
-
 		// loop over data
 		auto t = model.GetTime() == 0.0 ? 0.0 : model.GetTime() + model.fixed_control_step_size;
 		while ( t < end_time && !model.HasSimulationEnded() )
 		{
-#if 1 // set to 0 to disable this optimization
 			auto state_storage_idx = xo::round_cast<index_t>( t / fixed_control_step_size );
 			SCONE_ASSERT( state_storage_idx < storage_indices_.size() );
 			const auto& f = storage_.GetFrame( storage_indices_[state_storage_idx] );
 			model.AdvancePlayback( state_storage_[state_storage_idx], t );
-#else
-			const auto& f = storage_.GetClosestFrame( t );
-			for ( index_t state_idx = 0; state_idx < state_channels_.size(); ++state_idx )
-				state_values[state_idx] = f.GetValues()[state_channels_[state_idx]];
-			model.AdvancePlayback( state_values, t );
-#endif
 
 			// update activations based on computed excitations
 			const auto dt = model.fixed_control_step_size;
@@ -228,19 +195,13 @@ namespace scone
 			auto scale_factor = use_squared_error ? 1000 : 100;
 			total_error = scale_factor * total_error / muscles.size();
 			//log::trace( "t=", t, " frames=", frame_count, " start=", frame_start, " result=", result );
-			set_exact( mud["RPL_err"], get_exact( mud["RPL_err"] ) + total_error );
-			set_exact( mud["RPL_smp"], get_exact( mud["RPL_smp"] ) + samples );
-			if ( store_muscle_results )
-				for ( index_t idx = 0; idx < muscles.size(); ++idx ) {
-					auto& rpl_mus_pn = mud["RPL_mus"][muscles[idx]->GetName() + ".error"];
-					set_exact( rpl_mus_pn, get_exact( rpl_mus_pn ) + scale_factor * errors[idx] );
-				}
-		}
-
-		if ( t > 0 && !model.HasSimulationEnded() ) {
-			// keep activations for next round
-			for ( index_t idx = 0; idx < muscles.size(); ++idx )
-				set_exact( act_pn[idx], activations[idx] );
+			rs.total_error += total_error;
+			rs.samples += samples;
+			if ( store_muscle_results ) {
+				for ( index_t idx = 0; idx < muscles.size(); ++idx )
+					rs.muscle_errors[idx] += scale_factor * errors[idx];
+				rs.has_muscle_errors = true;
+			}
 		}
 	}
 
@@ -251,21 +212,21 @@ namespace scone
 
 	fitness_t ReplicationObjective::GetResult( Model& m ) const
 	{
-		auto& mud = m.GetUserData();
-		auto result = mud.get< fitness_t >( "RPL_err" ) / mud.get< index_t >( "RPL_smp" );
-		return result;
+		const auto* rs = m.TryGetSlot( state_slot_ );
+		SCONE_ERROR_IF( !rs, "No replication results available" );
+		return rs->total_error / rs->samples;
 	}
 
 	PropNode ReplicationObjective::GetReport( Model& m ) const
 	{
 		auto pn = xo::to_prop_node( GetResult( m ) );
 		auto& muscles = m.GetMuscles();
-		auto& mus_pn = m.GetUserData()["RPL_mus"];
-		auto samples = m.GetUserData().get< index_t >( "RPL_smp" );
-		auto errors = mus_pn.get<std::vector<double>>();
-		auto sidx = xo::sorted_indices( errors, std::greater<double>() );
-		for ( auto idx : sidx )
-			pn[muscles[idx]->GetName() + ".error"] = mus_pn[idx].get<double>() / samples;
+		const auto& rs = *m.TryGetSlot( state_slot_ );
+		if ( rs.has_muscle_errors ) {
+			auto sidx = xo::sorted_indices( rs.muscle_errors, std::greater<double>() );
+			for ( auto idx : sidx )
+				pn[muscles[idx]->GetName() + ".error"] = rs.muscle_errors[idx] / rs.samples;
+		}
 		return pn;
 	}
 }
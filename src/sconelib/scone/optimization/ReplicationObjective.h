@@ -11,6 +11,7 @@
 #include "scone/optimization/Objective.h"
 #include "scone/core/PropNode.h"
 #include "scone/core/Storage.h"
+#include "scone/model/ModelSlot.h"
 
 #include "xo/filesystem/path.h"
 #include "ModelObjective.h"
@@ -45,6 +46,17 @@ namespace scone
 		virtual PropNode GetReport( Model& m ) const override;
 
 	private:
+		// intermediate results, stored in the model
+		struct ReplicationState {
+			double total_error = 0.0;
+			size_t samples = 0;
+			std::vector<double> activations;
+			std::vector<double> muscle_errors;
+			std::vector<double> errors;
+			bool has_muscle_errors = false;
+		};
+		ModelSlot<ReplicationState> state_slot_;
+
 		Storage<> storage_;
 		std::vector<index_t> state_channels_;
 		xo::flat_map< index_t, index_t > muscle_excitation_map_;
@@ -25,6 +25,8 @@
 #include "spot/async_evaluator.h"
 #include "spot/pooled_evaluator.h"
 #include "EsOptimizer.h"
+#include "AsyncFileReporter.h"
+#include "ProcessEvaluator.h"
 #include "spot/console_reporter.h"
 
 using xo::timer;
@@ -117,8 +119,14 @@ namespace scone
 		return scenario_pn;
 	}
 
-	spot::evaluator& GetSpotEvaluator()
+	spot::evaluator& GetSpotEvaluator( s_ptr<spot::evaluator>& owned_evaluator, const s_ptr<spot::evaluator>& parent_evaluator )
 	{
+		if ( parent_evaluator )
+		{
+			owned_evaluator = parent_evaluator;
+			return *owned_evaluator;
+		}
+
 		auto eval = GetSconeSetting<int>( "optimizer.evaluator" );
 #if !defined(_MSC_VER)
 		// pool evaluator has issues with Linux and macOS
@@ -149,6 +157,17 @@ namespace scone
 			pooled_eval.set_max_threads( max_threads, thread_prio );
 			return pooled_eval;
 		}
+		else if ( eval == 4 )
+		{
+			// each root optimizer has its own worker processes, so concurrent optimizations do not wait for each other;
+			// child optimizers share the workers of their parent
+			ProcessEvaluatorSettings pes;
+			pes.worker_command = GetSconeSetting<String>( "optimizer.worker_command" );
+			pes.worker_count = max_threads > 0 ? max_threads : std::max( 1u, std::thread::hardware_concurrency() );
+			pes.task_timeout = GetSconeSetting<double>( "optimizer.worker_timeout" );
+			owned_evaluator = std::make_shared<ProcessEvaluator>( pes );
+			return *owned_evaluator;
+		}
 		else SCONE_THROW( "Invalid evaluator setting" );
 	}
 
@@ -167,8 +186,16 @@ namespace scone
 		}
 	}
 
-	std::unique_ptr<spot::file_reporter> MakeSpotFileReporter( const Optimizer& opt )
+	std::unique_ptr<spot::reporter> MakeSpotFileReporter( const Optimizer& opt )
 	{
+		if ( GetSconeSetting<bool>( "optimizer.async_file_output" ) && !GetSconeSetting<bool>( "optimizer.output_individual_search_points" ) )
+		{
+			auto afr = std::make_unique< AsyncFileReporter >( opt.GetOutputFolder(), opt.min_improvement_for_file_output, opt.max_generations_without_file_output );
+			afr->output_fitness_history_ = GetSconeSetting<bool>( "optimizer.output_fitness_history" );
+			afr->output_par_history_ = GetSconeSetting<bool>( "optimizer.output_par_history" );
+			return afr;
+		}
+
 		auto fr = std::make_unique< spot::file_reporter >( opt.GetOutputFolder(), opt.min_improvement_for_file_output, opt.max_generations_without_file_output );
 		fr->output_fitness_history_ = GetSconeSetting<bool>( "optimizer.output_fitness_history" );
 		fr->output_par_history_ = GetSconeSetting<bool>( "optimizer.output_par_history" );
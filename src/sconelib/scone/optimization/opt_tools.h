@@ -39,12 +39,14 @@ namespace scone
 	// Loads a scenario prop_node form a .scone or .par file. Adds empty version for .par files
 	SCONE_API PropNode LoadScenario( const path& scenario_or_par_file, std::vector<path>* included_files = nullptr );
 
-	// Gets spot::evaluator based on SCONE settings
-	SCONE_API spot::evaluator& GetSpotEvaluator();
+	// Gets spot::evaluator based on SCONE settings.
+	// Evaluators that cannot be shared between optimizers are created in owned_evaluator, which must outlive its use,
+	// unless parent_evaluator is set, which child optimizers use to share the evaluator of their parent.
+	SCONE_API spot::evaluator& GetSpotEvaluator( s_ptr<spot::evaluator>& owned_evaluator, const s_ptr<spot::evaluator>& parent_evaluator = nullptr );
 
 	// Make spot::reporter for internal reporting
 	SCONE_API std::unique_ptr<spot::reporter> MakeSpotReporter( Optimizer::OutputMode m );
 
-	// Make spot::file_reporter based on scone settings
-	SCONE_API std::unique_ptr<spot::file_reporter> MakeSpotFileReporter( const Optimizer& opt );
+	// Make file reporter based on scone settings, either spot::file_reporter or AsyncFileReporter
+	SCONE_API std::unique_ptr<spot::reporter> MakeSpotFileReporter( const Optimizer& opt );
 }
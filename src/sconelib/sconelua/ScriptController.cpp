@@ -13,6 +13,7 @@
 #include "lua_script.h"
 #include "lua_api.h"
 #include "scone/core/Log.h"
+#include "scone/core/random_tools.h"
 #include "scone/core/profiler_config.h"
 #include "xo/container/prop_node_tools.h"
 
@@ -22,7 +23,8 @@ namespace scone
 		CompositeController( pn, par, model, loc ),
 		script_file( FindFile( pn.get<path>( "script_file" ) ) ),
 		INIT_MEMBER( pn, external_files, std::vector<path>() ),
-		script_( new lua_script( script_file, pn ) )
+		random_seed( GetRandomSeed( pn, par ) ),
+		script_( new lua_script( script_file, pn, random_seed ) )
 	{
 		// optional functions
 		if ( auto f = script_->try_find_function( "init" ) )
@@ -43,6 +43,8 @@ namespace scone
 		-- 'current_frame' can be used to store values for analysis (see LuaFrame)
 	end
 	\endverbatim
+	For best performance, find muscles, dofs and bodies once in ''init'' and keep them in local variables,
+	use bulk accessors such as LuaModel::get_muscle_activations, and use LuaFrame::channel handles in ''store_data''.
 	See also LuaModel, LuaBody, LuaDof, LuaActuator, LuaMuscle, LuaFrame. See Tutorial 6a and 6b for more information.
 	*/
 	class SCONE_LUA_API ScriptController : public CompositeController
@@ -57,6 +59,9 @@ namespace scone
 		/// Array of files used by the Lua script; files included by 'require' should be added here as ''external_files = [ file1, file2 ]''
 		ArrayOfFiles external_files;
 
+		/// Seed for math.random in the Lua script, use 0 to derive a seed from the parameter values; default = 123.
+		unsigned int random_seed;
+
 		virtual void StoreData( Storage<Real>::Frame& frame, const StoreDataFlags& flags ) const override;
 
 		int TrySetControlParameter( const String& name, Real value ) override;
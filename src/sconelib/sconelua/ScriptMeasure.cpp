@@ -3,6 +3,7 @@
 #include "lua_script.h"
 #include "lua_api.h"
 #include "scone/core/Log.h"
+#include "scone/core/random_tools.h"
 #include "scone/core/profiler_config.h"
 
 namespace scone
@@ -11,7 +12,8 @@ namespace scone
 		Measure( pn, par, model, loc ),
 		script_file( FindFile( pn.get<path>( "script_file" ) ) ),
 		INIT_MEMBER( pn, external_files, std::vector<path>() ),
-		script_( new lua_script( script_file, pn ) )
+		random_seed( GetRandomSeed( pn, par ) ),
+		script_( new lua_script( script_file, pn, random_seed ) )
 	{
 		// optional functions
 		if ( auto f = script_->try_find_function( "init" ) )
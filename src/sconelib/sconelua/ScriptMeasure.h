@@ -52,6 +52,9 @@ namespace scone
 		/// Array of files used by the Lua script; files included by 'require' should be added here
 		std::vector<path> external_files;
 
+		/// Seed for math.random in the Lua script, use 0 to derive a seed from the parameter values; default = 123.
+		unsigned int random_seed;
+
 	protected:
 		virtual String GetClassSignature() const override;
 
@@ -21,6 +21,10 @@ namespace scone
 			"set_value", &LuaFrame::set_value,
 			"set_vec3", &LuaFrame::set_vec3,
 			"set_bool", &LuaFrame::set_bool,
+			"channel", &LuaFrame::channel,
+			"channel_vec3", &LuaFrame::channel_vec3,
+			"set_channel", &LuaFrame::set_channel,
+			"set_channel_vec3", &LuaFrame::set_channel_vec3,
 			"time", &LuaFrame::time
 			);
 
@@ -186,14 +190,24 @@ namespace scone
 			"set_gravity", &LuaModel::set_gravity,
 			"actuator", &LuaModel::actuator,
 			"find_actuator", &LuaModel::find_actuator,
+			"find_actuator_index", &LuaModel::find_actuator_index,
 			"actuator_count", &LuaModel::actuator_count,
+			"add_actuator_inputs", &LuaModel::add_actuator_inputs,
 			"dof", &LuaModel::dof,
 			"find_dof", &LuaModel::find_dof,
+			"find_dof_index", &LuaModel::find_dof_index,
 			"dof_count", &LuaModel::dof_count,
+			"get_dof_positions", &LuaModel::get_dof_positions,
+			"get_dof_velocities", &LuaModel::get_dof_velocities,
 			"init_state_from_dofs", &LuaModel::init_state_from_dofs,
 			"muscle", &LuaModel::muscle,
 			"find_muscle", &LuaModel::find_muscle,
+			"find_muscle_index", &LuaModel::find_muscle_index,
 			"muscle_count", &LuaModel::muscle_count,
+			"get_muscle_excitations", &LuaModel::get_muscle_excitations,
+			"get_muscle_activations", &LuaModel::get_muscle_activations,
+			"get_muscle_forces", &LuaModel::get_muscle_forces,
+			"get_muscle_fiber_lengths_norm", &LuaModel::get_muscle_fiber_lengths_norm,
 			"body", &LuaModel::body,
 			"find_body", &LuaModel::find_body,
 			"find_body_index", &LuaModel::find_body_index,
@@ -201,6 +215,7 @@ namespace scone
 			"ground_body", &LuaModel::ground_body,
 			"joint", &LuaModel::joint,
 			"find_joint", &LuaModel::find_joint,
+			"find_joint_index", &LuaModel::find_joint_index,
 			"joint_count", &LuaModel::joint_count,
 			"contact_force", &LuaModel::contact_force,
 			"contact_power", &LuaModel::contact_power,
@@ -113,9 +113,28 @@ namespace scone
 		void set_vec3( LuaString key, LuaVec3* pv ) { string s( key ); auto& v = LUA_ARG_REF( pv ); frame_[s + "_x"] = v.x; frame_[s + "_y"] = v.y; frame_[s + "_z"] = v.z; }
 		/// set a boolean (true or false) value for channel named key
 		void set_bool( LuaString key, bool b ) { frame_[key] = b ? 1.0 : 0.0; }
+		/// get a handle for channel named key, to be used in set_channel (the handle remains valid for all frames)
+		int channel( LuaString key ) { return static_cast<int>( frame_.AcquireChannelIndex( key ) ) + 1; }
+		/// get a handle for channels key_x, key_y and key_z, to be used in set_channel_vec3
+		int channel_vec3( LuaString key ) {
+			string s( key );
+			auto idx = frame_.AcquireChannelIndex( s + "_x" );
+			SCONE_ERROR_IF( frame_.AcquireChannelIndex( s + "_y" ) != idx + 1 || frame_.AcquireChannelIndex( s + "_z" ) != idx + 2,
+				"Channels for " + s + " are not consecutive" );
+			return static_cast<int>( idx ) + 1;
+		}
+		/// set a numeric value for channel handle (is ignored when nil)
+		void set_channel( int handle, sol::optional<LuaNumber> value ) { if ( value ) frame_[GetChannelIndex( handle, 1 )] = *value; }
+		/// set a vec3 value for channel handle obtained with channel_vec3
+		void set_channel_vec3( int handle, LuaVec3* pv ) { frame_.SetVec3( GetChannelIndex( handle, 3 ), LUA_ARG_REF( pv ) ); }
 		/// get time of current frame
 		LuaNumber time() { return frame_.GetTime(); }
 
+		index_t GetChannelIndex( int handle, size_t count ) {
+			SCONE_ERROR_IF( handle < 1 || handle - 1 + count > frame_.GetValues().size(), "Invalid channel handle: " + xo::to_str( handle ) );
+			return static_cast<index_t>( handle - 1 );
+		}
+
 		Storage<Real>::Frame& frame_;
 	};
 
@@ -517,15 +536,30 @@ namespace scone
 		LuaActuator actuator( int index ) { return *GetByLuaIndex( mod_.GetActuators(), index ); }
 		/// find an actuator with a specific name
 		LuaActuator find_actuator( LuaString name ) { return *GetByLuaName( mod_.GetActuators(), name ); }
+		/// find an actuator index with a specific name, returns 0 if not found
+		int find_actuator_index( LuaString name ) { return GetLuaIndex( mod_.GetActuators(), name ); }
 		/// number of actuators
 		int actuator_count() { return static_cast<int>( mod_.GetActuators().size() ); }
+		/// add the values of a table (starting at 1) to the inputs of all actuators; nil values are ignored
+		void add_actuator_inputs( sol::table values ) {
+			auto& acts = mod_.GetActuators();
+			for ( index_t i = 0; i < acts.size(); ++i )
+				if ( auto v = values.raw_get<sol::optional<LuaNumber>>( i + 1 ) )
+					acts[i]->AddInput( *v );
+		}
 
 		/// get the muscle at index (starting at 1)
 		LuaDof dof( int index ) { return *GetByLuaIndex( mod_.GetDofs(), index ); }
 		/// find a muscle with a specific name
 		LuaDof find_dof( LuaString name ) { return *GetByLuaName( mod_.GetDofs(), name ); }
+		/// find a dof index with a specific name, returns 0 if not found
+		int find_dof_index( LuaString name ) { return GetLuaIndex( mod_.GetDofs(), name ); }
 		/// number of dofs
 		int dof_count() { return static_cast<int>( mod_.GetDofs().size() ); }
+		/// fill a table with the positions of all dofs (starting at 1)
+		void get_dof_positions( sol::table values ) { FillTable( values, mod_.GetDofs(), []( const Dof* d ) { return d->GetPos(); } ); }
+		/// fill a table with the velocities of all dofs (starting at 1)
+		void get_dof_velocities( sol::table values ) { FillTable( values, mod_.GetDofs(), []( const Dof* d ) { return d->GetVel(); } ); }
 		/// Initialize the Model state from the current Dof values and equilibrate all muscles (must be called after modifying Dofs)
 		void init_state_from_dofs() { mod_.InitStateFromDofs(); }
 
@@ -533,8 +567,18 @@ namespace scone
 		LuaMuscle muscle( int index ) { return *GetByLuaIndex( mod_.GetMuscles(), index ); }
 		/// find a muscle with a specific name
 		LuaMuscle find_muscle( LuaString name ) { return *GetByLuaName( mod_.GetMuscles(), name ); }
+		/// find a muscle index with a specific name, returns 0 if not found
+		int find_muscle_index( LuaString name ) { return GetLuaIndex( mod_.GetMuscles(), name ); }
 		/// number of muscles
 		int muscle_count() { return static_cast<int>( mod_.GetMuscles().size() ); }
+		/// fill a table with the excitations of all muscles (starting at 1)
+		void get_muscle_excitations( sol::table values ) { FillTable( values, mod_.GetMuscles(), []( const Muscle* m ) { return m->GetExcitation(); } ); }
+		/// fill a table with the activations of all muscles (starting at 1)
+		void get_muscle_activations( sol::table values ) { FillTable( values, mod_.GetMuscles(), []( const Muscle* m ) { return m->GetActivation(); } ); }
+		/// fill a table with the forces of all muscles (starting at 1)
+		void get_muscle_forces( sol::table values ) { FillTable( values, mod_.GetMuscles(), []( const Muscle* m ) { return m->GetForce(); } ); }
+		/// fill a table with the normalized fiber lengths of all muscles (starting at 1)
+		void get_muscle_fiber_lengths_norm( sol::table values ) { FillTable( values, mod_.GetMuscles(), []( const Muscle* m ) { return m->GetNormalizedFiberLength(); } ); }
 
 		/// get the body at index (starting at 1)
 		LuaBody body( int index ) { return *GetByLuaIndex( mod_.GetBodies(), index ); }
@@ -551,6 +595,8 @@ namespace scone
 		LuaJoint joint( int index ) { return *GetByLuaIndex( mod_.GetJoints(), index ); }
 		/// find a joint with a specific name
 		LuaJoint find_joint( LuaString name ) { return *GetByLuaName( mod_.GetJoints(), name ); }
+		/// find a joint index with a specific name, returns 0 if not found
+		int find_joint_index( LuaString name ) { return GetLuaIndex( mod_.GetJoints(), name ); }
 		/// number of joints
 		int joint_count() { return static_cast<int>( mod_.GetJoints().size() ); }
 		
@@ -618,6 +664,10 @@ namespace scone
 
 	private:
 
+		template< typename C, typename F > void FillTable( sol::table& values, const C& items, F value_func ) {
+			for ( index_t i = 0; i < items.size(); ++i )
+				values.raw_set( i + 1, value_func( items[i] ) );
+		}
 		Muscle& FindMuscle( LuaString name ) { return *GetByLuaName( mod_.GetMuscles(), name ); }
 		template<typename T> SensorDelayAdapter& AcquireMuscleSensorDelayAdapter( LuaString name ) {
 			return mod_.AcquireDelayedSensor<T>( FindMuscle( name ) );
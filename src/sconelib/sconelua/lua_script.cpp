@@ -5,13 +5,199 @@
 #include "scone/model/Actuator.h"
 #include "lua_api.h"
 
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string_view>
+
 namespace scone
 {
-	lua_script::lua_script( const path& script_file, const PropNode& pn ) :
-		script_file_( script_file )
+	// math.random and math.randomseed replacements that use a generator owned by the Lua state,
+	// because the Lua 5.3 versions use the process-wide C rand()
+	using lua_random_engine = std::mt19937_64;
+
+	int lua_state_random( lua_State* L ) {
+		auto& rng = *static_cast<lua_random_engine*>( lua_touserdata( L, lua_upvalueindex( 1 ) ) );
+		lua_Integer low = 1, up = 1;
+		switch ( lua_gettop( L ) ) {
+		case 0:
+			lua_pushnumber( L, std::uniform_real_distribution<lua_Number>( 0, 1 )( rng ) );
+			return 1;
+		case 1:
+			up = luaL_checkinteger( L, 1 );
+			break;
+		case 2:
+			low = luaL_checkinteger( L, 1 );
+			up = luaL_checkinteger( L, 2 );
+			break;
+		default:
+			return luaL_error( L, "wrong number of arguments" );
+		}
+		luaL_argcheck( L, low <= up, 1, "interval is empty" );
+		lua_pushinteger( L, std::uniform_int_distribution<lua_Integer>( low, up )( rng ) );
+		return 1;
+	}
+
+	int lua_state_randomseed( lua_State* L ) {
+		auto& rng = *static_cast<lua_random_engine*>( lua_touserdata( L, lua_upvalueindex( 1 ) ) );
+		rng.seed( lua_random_engine::result_type( lua_Integer( luaL_checknumber( L, 1 ) ) ) );
+		return 0;
+	}
+
+	// Lua state with standard libraries and scone wrappers registered,
+	// which can be reset to its initial state for reuse by another script
+	struct pooled_lua_state
+	{
+		pooled_lua_state() {
+			lua.open_libraries( sol::lib::base, sol::lib::math, sol::lib::package, sol::lib::string );
+			register_lua_wrappers( lua );
+			register_random_functions();
+
+			// snapshot the globals and the tables they contain (libraries, package.loaded, scone)
+			std::set<const void*> visited;
+			take_snapshot( lua.globals(), 2, visited );
+		}
+
+		// restore all snapshot tables to their initial keys, values and metatables
+		// math.random is seeded by each lua_script that acquires the state
+		void reset() {
+			for ( auto& s : snapshots )
+				restore_snapshot( s );
+			lua.collect_garbage();
+		}
+
+		struct table_snapshot {
+			sol::table table;
+			sol::table entries; // copy of all key / value pairs
+			sol::object metatable;
+		};
+
+		void take_snapshot( sol::table t, int depth, std::set<const void*>& visited ) {
+			if ( !visited.insert( t.pointer() ).second )
+				return;
+			table_snapshot s{ t, lua.create_table(), sol::lua_nil };
+			for ( const auto& [key, value] : t ) {
+				s.entries.raw_set( key, value );
+				if ( depth > 0 && value.get_type() == sol::type::table )
+					take_snapshot( value.as<sol::table>(), depth - 1, visited );
+			}
+			lua_State* L = lua.lua_state();
+			t.push();
+			if ( lua_getmetatable( L, -1 ) ) {
+				s.metatable = sol::object( L, -1 );
+				lua_pop( L, 1 );
+			}
+			lua_pop( L, 1 );
+			snapshots.push_back( std::move( s ) );
+		}
+
+		void restore_snapshot( table_snapshot& s ) {
+			// remove keys that were added
+			std::vector<sol::object> added;
+			for ( const auto& [key, value] : s.table )
+				if ( s.entries.raw_get<sol::object>( key ).get_type() == sol::type::lua_nil )
+					added.push_back( key );
+			for ( const auto& key : added )
+				s.table.raw_set( key, sol::lua_nil );
+
+			// restore original values, including those that were overwritten or removed
+			for ( const auto& [key, value] : s.entries )
+				s.table.raw_set( key, value );
+
+			// restore metatable
+			lua_State* L = lua.lua_state();
+			s.table.push();
+			s.metatable.push();
+			lua_setmetatable( L, -2 );
+			lua_pop( L, 1 );
+		}
+
+		void register_random_functions() {
+			lua_State* L = lua.lua_state();
+			lua_getglobal( L, "math" );
+			lua_pushlightuserdata( L, &random_engine );
+			lua_pushcclosure( L, lua_state_random, 1 );
+			lua_setfield( L, -2, "random" );
+			lua_pushlightuserdata( L, &random_engine );
+			lua_pushcclosure( L, lua_state_randomseed, 1 );
+			lua_setfield( L, -2, "randomseed" );
+			lua_pop( L, 1 );
+		}
+
+		lua_random_engine random_engine;
+		sol::state lua;
+		std::vector<table_snapshot> snapshots;
+	};
+
+	// per-thread pool of Lua states that are ready for use
+	constexpr size_t max_lua_state_pool_size = 8;
+	std::vector< u_ptr< pooled_lua_state > >& get_lua_state_pool() {
+		thread_local std::vector< u_ptr< pooled_lua_state > > pool;
+		return pool;
+	}
+
+	u_ptr< pooled_lua_state > acquire_lua_state() {
+		auto& pool = get_lua_state_pool();
+		if ( pool.empty() )
+			return std::make_unique<pooled_lua_state>();
+		auto state = std::move( pool.back() );
+		pool.pop_back();
+		return state;
+	}
+
+	void release_lua_state( u_ptr< pooled_lua_state > state ) {
+		try {
+			auto& pool = get_lua_state_pool();
+			if ( pool.size() < max_lua_state_pool_size ) {
+				state->reset();
+				pool.push_back( std::move( state ) );
+			}
+		}
+		catch ( std::exception& e ) {
+			log::warning( "Could not reset Lua state: ", e.what() );
+		}
+	}
+
+	// compiled script bytecode, shared between threads and invalidated when the file changes
+	struct lua_bytecode_entry {
+		std::filesystem::file_time_type write_time;
+		std::shared_ptr<const std::string> bytecode;
+	};
+	std::mutex g_lua_bytecode_mutex;
+	std::map< std::string, lua_bytecode_entry > g_lua_bytecode_cache;
+
+	std::shared_ptr<const std::string> get_lua_bytecode( sol::state& lua, const path& file ) {
+		std::error_code ec;
+		auto write_time = std::filesystem::last_write_time( file.str(), ec );
+		{
+			std::scoped_lock lock( g_lua_bytecode_mutex );
+			if ( auto it = g_lua_bytecode_cache.find( file.str() ); it != g_lua_bytecode_cache.end() && it->second.write_time == write_time )
+				return it->second.bytecode;
+		}
+
+		auto script = lua.load_file( file.str() );
+		if ( !script.valid() )
+		{
+			sol::error err = script;
+			SCONE_ERROR( "Error in " + file.filename().str() + ": " + err.what() );
+		}
+		sol::protected_function script_func = script;
+		sol::bytecode bc = script_func.dump();
+		auto bytecode = std::make_shared<const std::string>( bc.as_string_view() );
+
+		std::scoped_lock lock( g_lua_bytecode_mutex );
+		g_lua_bytecode_cache[file.str()] = { write_time, bytecode };
+		return bytecode;
+	}
+
+	lua_script::lua_script( const path& script_file, const PropNode& pn, unsigned int random_seed ) :
+		script_file_( script_file ),
+		state_( acquire_lua_state() ),
+		lua_( state_->lua )
 	{
-		lua_.open_libraries( sol::lib::base, sol::lib::math, sol::lib::package, sol::lib::string );
-		register_lua_wrappers( lua_ );
+		state_->random_engine.seed( random_seed );
 
 		// find script file (folder can be different if playback)
 		auto folder = script_file_.has_parent_path() ? script_file_.parent_path() : path( "." );
@@ -24,8 +210,9 @@ namespace scone
 		for ( auto& prop : pn )
 			lua_["scone"][prop.first] = prop.second.get<string>();
 
-		// load script
-		auto script = lua_.load_file( script_file_.str() );
+		// load script from cached bytecode
+		auto bytecode = get_lua_bytecode( lua_, script_file_ );
+		auto script = lua_.load( std::string_view( *bytecode ), "@" + script_file_.str(), sol::load_mode::binary );
 		if ( !script.valid() )
 		{
 			sol::error err = script;
@@ -42,7 +229,9 @@ namespace scone
 	}
 
 	lua_script::~lua_script()
-	{}
+	{
+		release_lua_state( std::move( state_ ) );
+	}
 
 	sol::function lua_script::find_function( const String& name )
 	{
@@ -11,7 +11,7 @@ namespace scone
 	class lua_script
 	{
 	public:
-		lua_script( const path& script_file, const PropNode& props );
+		lua_script( const path& script_file, const PropNode& props, unsigned int random_seed );
 		~lua_script();
 
 		sol::function find_function( const String& name );
@@ -19,6 +19,8 @@ namespace scone
 		xo::path script_file_;
 
 	private:
-		sol::state lua_;
+		// pre-initialized Lua state, taken from a per-thread pool and returned after use
+		u_ptr< struct pooled_lua_state > state_;
+		sol::state& lua_;
 	};
 }
@@ -9,6 +9,7 @@
 #include <variant>
 #include "xo/geometry/quat.h"
 #include "scone/core/Log.h"
+#include "scone/core/AllocationTracker.h"
 
 namespace scone
 {
@@ -138,9 +139,12 @@ namespace scone
 		// update m_ContactForceValues only if needed (performance)
 		if ( m_LastNumDynamicsRealizations != num_dyn )
 		{
-			OpenSim::Array<double> forces = m_osForce.getRecordValues( tkState );
-			for ( int i = 0; i < forces.size(); ++i )
-				m_Values[i] = forces[i];
+			{
+				const AllocationExemption exemption; // OpenSim returns the values in a new Array
+				OpenSim::Array<double> forces = m_osForce.getRecordValues( tkState );
+				for ( int i = 0; i < forces.size(); ++i )
+					m_Values[i] = forces[i];
+			}
 			m_LastNumDynamicsRealizations = num_dyn;
 
 			m_Force.set( -m_Values[0], -m_Values[1], -m_Values[2] );
@@ -77,8 +77,10 @@ namespace scone
 
 	void DofOpenSim3::SetPos( Real pos )
 	{
-		if ( !m_osCoord.getLocked( m_Model.GetTkState() ) )
+		if ( !m_osCoord.getLocked( m_Model.GetTkState() ) ) {
 			m_osCoord.setValue( m_Model.GetTkState(), pos, false );
+			m_Model.InvalidateRayCaster();
+		}
 	}
 
 	void DofOpenSim3::SetVel( Real vel )
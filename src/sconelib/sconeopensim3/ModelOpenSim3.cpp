@@ -27,6 +27,7 @@
 
 #include "scone/core/system_tools.h"
 #include "scone/core/profiler_config.h"
+#include "scone/core/AllocationTracker.h"
 
 #include "xo/string/string_tools.h"
 #include "xo/string/pattern_matcher.h"
@@ -38,6 +39,8 @@
 #include "spot/par_tools.h"
 
 #include <mutex>
+#include <map>
+#include <filesystem>
 #include "xo/serialization/serialize.h"
 
 using std::cout;
@@ -51,6 +54,27 @@ namespace scone
 	xo::file_resource_cache< OpenSim::Model, std::string > g_ModelCache;
 	xo::file_resource_cache< OpenSim::Storage, std::string > g_StorageCache;
 
+	// Create a copy of an OpenSim model from a per-thread template, which is copied once from g_ModelCache.
+	// This way, concurrent model construction never copies from an OpenSim::Model that is shared between threads.
+	std::unique_ptr<OpenSim::Model> CreateOsimModelFromThreadTemplate( const path& file )
+	{
+		struct ModelTemplate {
+			std::filesystem::file_time_type write_time;
+			std::unique_ptr<OpenSim::Model> model;
+		};
+		thread_local std::map<std::string, ModelTemplate> templates;
+
+		std::error_code ec;
+		auto write_time = std::filesystem::last_write_time( file.str(), ec );
+		auto& mt = templates[file.str()];
+		if ( !mt.model || mt.write_time != write_time ) {
+			std::scoped_lock lock( g_CloneModelMutex );
+			mt.model = g_ModelCache( file.str() );
+			mt.write_time = write_time;
+		}
+		return std::make_unique<OpenSim::Model>( *mt.model );
+	}
+
 	// OpenSim3 controller that calls scone controllers
 	class ControllerDispatcher : public OpenSim::Controller
 	{
@@ -109,13 +133,11 @@ namespace scone
 			SCONE_PROFILE_SCOPE( GetProfiler(), "CreateModel" );
 			model_file = FindFile( model_file );
 
-			{
-				// use lock if safe_mode
-				std::unique_lock model_lock( g_CloneModelMutex, std::defer_lock );
-				if ( safe_mode )
-					model_lock.lock();
+			if ( safe_mode ) {
+				std::scoped_lock lock( g_CloneModelMutex );
 				m_pOsimModel = g_ModelCache( model_file.str() );
 			}
+			else m_pOsimModel = CreateOsimModelFromThreadTemplate( model_file ); // per-thread copy, no lock required
 
 			AddExternalResource( model_file );
 		}
@@ -520,6 +542,8 @@ namespace scone
 
 	void ControllerDispatcher::computeControls( const SimTK::State& s, SimTK::Vector& controls ) const
 	{
+		SCONE_PROFILE_FUNCTION( m_Model.GetProfiler() );
+
 		// see 'catch' statement below for explanation try {} catch {} is needed
 		try
 		{
@@ -615,6 +639,7 @@ namespace scone
 
 				{
 					SCONE_PROFILE_SCOPE( GetProfiler(), "SimTK::TimeStepper::stepTo" );
+					const AllocationExemption exemption;
 					auto st = xo::scoped_timer_starter( m_SimulationTimer );
 					auto status = m_pTkTimeStepper->stepTo( target_time );
 					if ( status == SimTK::Integrator::EndOfSimulation )
@@ -630,6 +655,7 @@ namespace scone
 				// this way the results are always consistent
 				{
 					SCONE_PROFILE_SCOPE( GetProfiler(), "SimTK::MultibodySystem::realize" );
+					const AllocationExemption exemption;
 					m_pOsimModel->getMultibodySystem().realize( GetTkState(), SimTK::Stage::Acceleration );
 				}
 
@@ -652,6 +678,7 @@ namespace scone
 		{
 			// Integrate from initial time to final time (the old way)
 			SCONE_PROFILE_SCOPE( GetProfiler(), "OpenSim::Manager::integrate" );
+			const AllocationExemption exemption;
 			auto st = xo::scoped_timer_starter( m_SimulationTimer );
 			m_pOsimManager->setFinalTime( time );
 			m_pOsimManager->integrate( GetTkState() );
@@ -808,6 +835,7 @@ namespace scone
 
 	void ModelOpenSim3::CopyStateToTk()
 	{
+		InvalidateRayCaster();
 		SCONE_ASSERT( m_State.GetSize() >= GetOsimModel().getNumStateVariables() );
 		GetOsimModel().setStateValues( GetTkState(), &m_State.GetValues()[0] );
 
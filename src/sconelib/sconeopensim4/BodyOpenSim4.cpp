@@ -28,7 +28,9 @@ namespace scone
 		Body(),
 		m_osBody( body ),
 		m_pBody( dynamic_cast<const OpenSim::Body*>( &m_osBody ) ),
-		m_Model( model )
+		m_Model( model ),
+		m_ContactForceSum( Vec3::zero() ),
+		m_ContactMomentSum( Vec3::zero() )
 	{
 		m_LocalComPos = m_pBody ? from_osim( m_pBody->getMassCenter() ) : Vec3::zero();
 	}
@@ -63,13 +65,25 @@ namespace scone
 
 	Vec3 BodyOpenSim4::GetContactForce() const
 	{
-		return std::accumulate( m_ContactForces.begin(), m_ContactForces.end(), Vec3::zero(),
-			[&]( const Vec3& v, const ContactForce* cf ) { return v + cf->GetForce(); } );
+		if ( m_ContactForces.empty() )
+			return Vec3::zero();
+		m_Model.UpdateContactForceValues();
+		return m_ContactForceSum;
 	}
 
 	Vec3 BodyOpenSim4::GetContactMoment() const
 	{
-		return std::accumulate( m_ContactForces.begin(), m_ContactForces.end(), Vec3::zero(),
+		if ( m_ContactForces.empty() )
+			return Vec3::zero();
+		m_Model.UpdateContactForceValues();
+		return m_ContactMomentSum;
+	}
+
+	void BodyOpenSim4::UpdateContactSums() const
+	{
+		m_ContactForceSum = std::accumulate( m_ContactForces.begin(), m_ContactForces.end(), Vec3::zero(),
+			[&]( const Vec3& v, const ContactForce* cf ) { return v + cf->GetForce(); } );
+		m_ContactMomentSum = std::accumulate( m_ContactForces.begin(), m_ContactForces.end(), Vec3::zero(),
 			[&]( const Vec3& v, const ContactForce* cf ) { return v + cf->GetMoment(); } );
 	}
 
@@ -118,6 +132,7 @@ namespace scone
 	std::vector<ForceAtPoint> BodyOpenSim4::GetContactForceValues() const
 	{
 		std::vector<ForceAtPoint> result;
+		result.reserve( m_ContactForces.size() );
 		for ( const auto& cf : m_ContactForces )
 			result.emplace_back( cf->GetForceValue() );
 		return result;
@@ -220,8 +235,7 @@ namespace scone
 
 	Vec3 BodyOpenSim4::GetComAcc() const
 	{
-		// #todo: see if we need to do this call to realize every time (maybe do it once before controls are updated)
-		m_osBody.getModel().getMultibodySystem().realize( m_Model.GetTkState(), SimTK::Stage::Acceleration );
+		m_Model.Realize( SimTK::Stage::Acceleration );
 
 		// #todo: OSIM: find what is the most efficient (compare to linvel)
 		SimTK::Vec3 com = m_pBody ? m_pBody->getMassCenter() : SimTK::Vec3( 0 );
@@ -234,8 +248,7 @@ namespace scone
 
 	Vec3 BodyOpenSim4::GetOriginAcc() const
 	{
-		// #todo: see if we need to do this call to realize every time (maybe do it once before controls are updated)
-		m_osBody.getModel().getMultibodySystem().realize( m_Model.GetTkState(), SimTK::Stage::Acceleration );
+		m_Model.Realize( SimTK::Stage::Acceleration );
 
 		// #todo: OSIM: see if we can do this more efficient
 		const SimTK::MobilizedBody& mob = m_osBody.getModel().getMultibodySystem().getMatterSubsystem().getMobilizedBody( m_osBody.getMobilizedBodyIndex() );
@@ -244,8 +257,7 @@ namespace scone
 
 	Vec3 BodyOpenSim4::GetAngAcc() const
 	{
-		// #todo: see if we need to do this call to realize every time (maybe do it once before controls are updated)
-		m_osBody.getModel().getMultibodySystem().realize( m_Model.GetTkState(), SimTK::Stage::Acceleration );
+		m_Model.Realize( SimTK::Stage::Acceleration );
 
 		// #todo: cache this baby (after profiling), because sensors evaluate it for each channel
 		auto& mb = m_osBody.getModel().getMultibodySystem().getMatterSubsystem().getMobilizedBody( m_osBody.getMobilizedBodyIndex() );
@@ -254,8 +266,7 @@ namespace scone
 
 	Vec3 BodyOpenSim4::GetLinAccOfPointOnBody( Vec3 point ) const
 	{
-		// #todo: see if we need to do this call to realize every time (maybe do it once before controls are updated)
-		m_osBody.getModel().getMultibodySystem().realize( m_Model.GetTkState(), SimTK::Stage::Acceleration );
+		m_Model.Realize( SimTK::Stage::Acceleration );
 
 		const SimTK::MobilizedBody& mob = m_osBody.getModel().getMultibodySystem().getMatterSubsystem().getMobilizedBody( m_osBody.getMobilizedBodyIndex() );
 		return from_osim( mob.findStationAccelerationInGround( m_Model.GetTkState(), SimTK::Vec3( point.x, point.y, point.z ) ) );
@@ -79,11 +79,16 @@ namespace scone
 
 		void AttachContactForce( ContactForce* cf ) { m_ContactForces.push_back( cf ); }
 
+		// update contact force and moment sums, called by ModelOpenSim4::UpdateContactForceValues()
+		void UpdateContactSums() const;
+
 	private:
 		const OpenSim::PhysicalFrame& m_osBody;
 		const OpenSim::Body* m_pBody;
 		class ModelOpenSim4& m_Model;
 		Vec3 m_LocalComPos;
 		std::vector< ContactForce* > m_ContactForces;
+		mutable Vec3 m_ContactForceSum;
+		mutable Vec3 m_ContactMomentSum;
 	};
 }
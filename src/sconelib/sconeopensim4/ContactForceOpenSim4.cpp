@@ -9,6 +9,7 @@
 #include <variant>
 #include "xo/geometry/quat.h"
 #include "scone/core/Log.h"
+#include "scone/core/AllocationTracker.h"
 
 namespace scone
 {
@@ -25,7 +26,6 @@ namespace scone
 		m_Force(),
 		m_Moment(),
 		m_Point(),
-		m_LastNumDynamicsRealizations( -1 ),
 		m_PlaneNormal(),
 		m_PlaneLocation()
 	{
@@ -120,56 +120,45 @@ namespace scone
 
 	const Vec3& ContactForceOpenSim4::GetForce() const
 	{
-		UpdateForceValues();
+		m_Model.UpdateContactForceValues();
 		return m_Force;
 	}
 
 	const Vec3& ContactForceOpenSim4::GetMoment() const
 	{
-		UpdateForceValues();
+		m_Model.UpdateContactForceValues();
 		return m_Moment;
 	}
 
 	const Vec3& ContactForceOpenSim4::GetPoint() const
 	{
-		UpdateForceValues();
+		m_Model.UpdateContactForceValues();
 		return m_Point;
 	}
 
 	std::tuple<const Vec3&, const Vec3&, const Vec3&> ContactForceOpenSim4::GetForceMomentPoint() const
 	{
-		UpdateForceValues();
+		m_Model.UpdateContactForceValues();
 		return { m_Force, m_Moment, m_Point };
 	}
 
 	ForceAtPoint ContactForceOpenSim4::GetForceValue() const
 	{
-		UpdateForceValues();
+		m_Model.UpdateContactForceValues();
 		return { m_Force, m_Point };
 	}
 
-	void ContactForceOpenSim4::UpdateForceValues() const
+	void ContactForceOpenSim4::ComputeForceValues( const SimTK::State& s ) const
 	{
-		auto& osModel = m_Model.GetOsimModel();
-		auto& tkState = m_Model.GetTkState();
-
-		// realize the state and check the number of realizations
-		// IMPORTANT: we use the getNumRealizationsOfThisStage() instead of time or step
-		// because FixTkState() calls this multiple times before integration
-		osModel.getMultibodySystem().realize( tkState, SimTK::Stage::Dynamics );
-		int num_dyn = osModel.getMultibodySystem().getNumRealizationsOfThisStage( SimTK::Stage::Dynamics );
-
-		// update m_ContactForceValues only if needed (performance)
-		if ( m_LastNumDynamicsRealizations != num_dyn )
 		{
-			OpenSim::Array<double> forces = m_osForce.getRecordValues( tkState );
+			const AllocationExemption exemption; // OpenSim returns the values in a new Array
+			OpenSim::Array<double> forces = m_osForce.getRecordValues( s );
 			for ( int i = 0; i < forces.size(); ++i )
 				m_Values[i] = forces[i];
-			m_LastNumDynamicsRealizations = num_dyn;
-
-			m_Force.set( -m_Values[0], -m_Values[1], -m_Values[2] );
-			m_Moment.set( -m_Values[3], -m_Values[4], -m_Values[5] );
-			m_Point = GetPlaneCop( m_PlaneNormal, m_PlaneLocation, m_Force, m_Moment );
 		}
+
+		m_Force.set( -m_Values[0], -m_Values[1], -m_Values[2] );
+		m_Moment.set( -m_Values[3], -m_Values[4], -m_Values[5] );
+		m_Point = GetPlaneCop( m_PlaneNormal, m_PlaneLocation, m_Force, m_Moment );
 	}
 }
@@ -33,6 +33,9 @@ namespace scone
 		virtual std::tuple<const Vec3&, const Vec3&, const Vec3&> GetForceMomentPoint() const override;
 		ForceAtPoint GetForceValue() const override;
 
+		// compute force values for a realized state, called by ModelOpenSim4::UpdateContactForceValues()
+		void ComputeForceValues( const SimTK::State& s ) const;
+
 	private:
 		const OpenSim::Force& m_osForce;
 		ModelOpenSim4& m_Model;
@@ -41,8 +44,6 @@ namespace scone
 		mutable Vec3 m_Moment;
 		mutable Vec3 m_Point;
 
-		void UpdateForceValues() const;
-		mutable int m_LastNumDynamicsRealizations;
 		mutable std::vector< Real > m_Values;
 		std::vector< String > m_Labels;
 		Vec3 m_PlaneNormal;
@@ -67,6 +67,7 @@ namespace scone
 
 	Real DofOpenSim4::GetAcc() const
 	{
+		m_Model.Realize( SimTK::Stage::Acceleration );
 		return m_osCoord.getAccelerationValue( m_Model.GetTkState() );
 	}
 
@@ -84,14 +85,18 @@ namespace scone
 
 	void DofOpenSim4::SetPos( Real pos )
 	{
-		if ( !m_osCoord.getLocked( m_Model.GetTkState() ) )
+		if ( !m_osCoord.getLocked( m_Model.GetTkState() ) ) {
 			m_osCoord.setValue( m_Model.GetTkState(), pos, false );
+			m_Model.InvalidateBodyKinematics();
+		}
 	}
 
 	void DofOpenSim4::SetVel( Real vel )
 	{
-		if ( !m_osCoord.getLocked( m_Model.GetTkState() ) )
+		if ( !m_osCoord.getLocked( m_Model.GetTkState() ) ) {
 			m_osCoord.setSpeedValue( m_Model.GetTkState(), vel );
+			m_Model.InvalidateBodyKinematics();
+		}
 	}
 
 	bool DofOpenSim4::IsRotational() const
@@ -43,7 +43,7 @@ namespace scone
 		auto& state = m_Model.GetTkState();
 		auto child_body_idx = m_osJoint.getChildFrame().getMobilizedBodyIndex();
 
-		model.getMultibodySystem().realize( state, SimTK::Stage::Acceleration );
+		m_Model.Realize( SimTK::Stage::Acceleration );
 		SimTK::Vector_< SimTK::SpatialVec > forcesAtMInG;
 		matter.calcMobilizerReactionForces( state, forcesAtMInG ); // state should be at acceleration
 
@@ -31,6 +31,7 @@
 
 #include "scone/core/system_tools.h"
 #include "scone/core/profiler_config.h"
+#include "scone/core/AllocationTracker.h"
 
 #include "xo/string/string_tools.h"
 #include "xo/string/pattern_matcher.h"
@@ -42,6 +43,8 @@
 #include "spot/par_tools.h"
 
 #include <mutex>
+#include <map>
+#include <filesystem>
 #include "xo/serialization/serialize.h"
 
 using std::cout;
@@ -50,10 +53,32 @@ using std::endl;
 namespace scone
 {
 	std::mutex g_OpenSim4Mutex;
+	std::mutex g_CloneModelMutex; // guards access to g_ModelCache
 
 	xo::file_resource_cache< OpenSim::Model, std::string > g_ModelCache;
 	xo::file_resource_cache< OpenSim::Storage, std::string > g_StorageCache;
 
+	// Create a copy of an OpenSim model from a per-thread template, which is copied once from g_ModelCache.
+	// This way, concurrent model construction never copies from an OpenSim::Model that is shared between threads.
+	std::unique_ptr<OpenSim::Model> CreateOsimModelFromThreadTemplate( const path& file )
+	{
+		struct ModelTemplate {
+			std::filesystem::file_time_type write_time;
+			std::unique_ptr<OpenSim::Model> model;
+		};
+		thread_local std::map<std::string, ModelTemplate> templates;
+
+		std::error_code ec;
+		auto write_time = std::filesystem::last_write_time( file.str(), ec );
+		auto& mt = templates[file.str()];
+		if ( !mt.model || mt.write_time != write_time ) {
+			std::scoped_lock lock( g_CloneModelMutex );
+			mt.model = g_ModelCache( file.str() );
+			mt.write_time = write_time;
+		}
+		return std::make_unique<OpenSim::Model>( *mt.model );
+	}
+
 	// OpenSim4 controller that calls scone controllers
 	class ControllerDispatcher : public OpenSim::Controller
 	{
@@ -72,12 +97,17 @@ namespace scone
 	ModelOpenSim4::ModelOpenSim4( const PropNode& props, Params& par ) :
 		Model( props, par ),
 		INIT_MEMBER( props, safe_mode, false ),
+		INIT_MEMBER( props, realize_required_stage, true ),
+		INIT_MEMBER( props, cache_body_kinematics, true ),
+		INIT_MEMBER( props, cache_contact_forces, true ),
 		m_pOsimModel( nullptr ),
 		m_pTkState( nullptr ),
 		m_pProbe( 0 ),
+		m_LastContactForceRealization( -1 ),
 		m_pControllerDispatcher( nullptr ),
 		m_PrevIntStep( -1 ),
 		m_PrevTime( 0.0 ),
+		m_PrevControlTime( 0.0 ),
 		m_EndTime( xo::constants<TimeInSeconds>::max() ),
 		m_Mass( 0.0 ),
 		m_BW( 0.0 )
@@ -114,6 +144,7 @@ namespace scone
 
 		// The following section is wrapped inside a mutex (when safe_mode = 1 ), to prevent random crashes
 		// The cause of this uncertain, but relates to https://github.com/opensim-org/opensim-core/issues/2944
+		// Without safe_mode, models are copied from a per-thread template and constructed concurrently
 		{
 			SCONE_PROFILE_SCOPE( GetProfiler(), "LockedInit" );
 
@@ -126,7 +157,11 @@ namespace scone
 				// create new OpenSim Model using resource cache
 				SCONE_PROFILE_SCOPE( GetProfiler(), "CreateModel" );
 				model_file = FindFile( model_file );
-				m_pOsimModel = g_ModelCache( model_file.str() );
+				if ( safe_mode ) {
+					std::scoped_lock lock( g_CloneModelMutex );
+					m_pOsimModel = g_ModelCache( model_file.str() );
+				}
+				else m_pOsimModel = CreateOsimModelFromThreadTemplate( model_file );
 				AddExternalResource( model_file );
 			}
 
@@ -235,6 +270,7 @@ namespace scone
 			m_pTkIntegrator->setAccuracy( integration_accuracy );
 			m_pTkIntegrator->setMaximumStepSize( max_integration_step_size );
 			m_pTkIntegrator->resetAllStatistics();
+			m_RealizeCountsAtReset = GetRealizeCounts();
 		}
 
 		// read initial state
@@ -416,6 +452,13 @@ namespace scone
 		}
 		CopyUniquePtrVec( m_Ligaments, m_LigamentPtrs );
 
+		// keep contact forces and bodies for batched contact force updates
+		for ( auto& cf : m_ContactForces )
+			m_OsimContactForces.push_back( &dynamic_cast<ContactForceOpenSim4&>( *cf ) );
+		for ( auto& b : m_Bodies )
+			if ( b->HasContactGeometry() )
+				m_ContactBodies.push_back( &dynamic_cast<BodyOpenSim4&>( *b ) );
+
 		// create legs and connect stance_contact forces
 		for ( auto side : { Side::Left, Side::Right } )
 		{
@@ -522,35 +565,147 @@ namespace scone
 		}
 	}
 
+	ModelOpenSim4::BodyKinematics& ModelOpenSim4::UpdBodyKinematics() const
+	{
+		// each quantity is computed separately on request, because the state may not be realized to Acceleration
+		if ( !cache_body_kinematics || m_BodyKinematics.time != GetTkState().getTime() ) {
+			m_BodyKinematics = BodyKinematics();
+			m_BodyKinematics.time = GetTkState().getTime();
+		}
+		return m_BodyKinematics;
+	}
+
 	Vec3 ModelOpenSim4::GetComPos() const
 	{
-		return from_osim( m_pOsimModel->calcMassCenterPosition( GetTkState() ) );
+		auto& bk = UpdBodyKinematics();
+		if ( !bk.com_pos )
+			bk.com_pos = from_osim( m_pOsimModel->calcMassCenterPosition( GetTkState() ) );
+		return *bk.com_pos;
 	}
 
 	Vec3 ModelOpenSim4::GetComVel() const
 	{
-		return from_osim( m_pOsimModel->calcMassCenterVelocity( GetTkState() ) );
+		auto& bk = UpdBodyKinematics();
+		if ( !bk.com_vel )
+			bk.com_vel = from_osim( m_pOsimModel->calcMassCenterVelocity( GetTkState() ) );
+		return *bk.com_vel;
 	}
 
 	Vec3 ModelOpenSim4::GetComAcc() const
 	{
-		return from_osim( m_pOsimModel->calcMassCenterAcceleration( GetTkState() ) );
+		auto& bk = UpdBodyKinematics();
+		if ( !bk.com_acc ) {
+			Realize( SimTK::Stage::Acceleration );
+			bk.com_acc = from_osim( m_pOsimModel->calcMassCenterAcceleration( GetTkState() ) );
+		}
+		return *bk.com_acc;
 	}
 
 	Vec3 ModelOpenSim4::GetLinMom() const
 	{
-		return from_osim( m_pOsimModel->getMatterSubsystem().calcSystemCentralMomentum( GetTkState() )[1] );
+		return GetLinAngMom().first;
 	}
 
 	Vec3 ModelOpenSim4::GetAngMom() const
 	{
-		return from_osim( m_pOsimModel->getMatterSubsystem().calcSystemCentralMomentum( GetTkState() )[0] );
+		return GetLinAngMom().second;
 	}
 
 	std::pair<Vec3, Vec3> ModelOpenSim4::GetLinAngMom() const
 	{
-		auto cm = m_pOsimModel->getMatterSubsystem().calcSystemCentralMomentum( GetTkState() );
-		return std::pair<Vec3, Vec3>( from_osim( cm[1] ), from_osim( cm[0] ) );
+		auto& bk = UpdBodyKinematics();
+		if ( !bk.lin_ang_mom ) {
+			auto cm = m_pOsimModel->getMatterSubsystem().calcSystemCentralMomentum( GetTkState() );
+			bk.lin_ang_mom.emplace( from_osim( cm[1] ), from_osim( cm[0] ) );
+		}
+		return *bk.lin_ang_mom;
+	}
+
+	void ModelOpenSim4::Realize( SimTK::Stage stage ) const
+	{
+		const auto& s = GetTkState();
+		if ( s.getSystemStage() < stage )
+		{
+			SCONE_PROFILE_SCOPE( GetProfiler(), "SimTK::MultibodySystem::realize" );
+			const AllocationExemption exemption;
+			if ( stage == SimTK::Stage::Acceleration )
+			{
+				auto st = xo::scoped_timer_starter( m_RealizeStats.timer );
+				m_pOsimModel->getMultibodySystem().realize( s, stage );
+				++m_RealizeStats.count;
+			}
+			else m_pOsimModel->getMultibodySystem().realize( s, stage );
+		}
+	}
+
+	void ModelOpenSim4::RealizeRequiredStage( bool store_frame ) const
+	{
+		// stored data includes accelerations
+		const auto stage = store_frame || !realize_required_stage ? SimulationStage::Acceleration : GetRequiredStage();
+		switch ( stage )
+		{
+		case SimulationStage::Position: Realize( SimTK::Stage::Position ); break;
+		case SimulationStage::Velocity: Realize( SimTK::Stage::Velocity ); break;
+		case SimulationStage::Dynamics: Realize( SimTK::Stage::Dynamics ); break;
+		case SimulationStage::Acceleration: Realize( SimTK::Stage::Acceleration ); break;
+		}
+	}
+
+	std::vector<std::pair<String, std::pair<xo::time, size_t>>> ModelOpenSim4::GetBenchmarks() const
+	{
+		// the saved time is estimated from the average duration of a realization to Acceleration
+		const auto& rs = m_RealizeStats;
+		const auto realize_time = rs.timer();
+		const auto saved_time = rs.count > 0 ? realize_time.secondsd() * rs.skipped / rs.count : 0.0;
+		return {
+			{ "Simulation", { m_SimulationTimer(), 1 } },
+			{ "RealizeAcceleration", { realize_time, std::max<size_t>( rs.count, 1 ) } },
+			{ "RealizeAccelerationSaved", { xo::time_from_seconds( saved_time ), 1 } }
+		};
+	}
+
+	std::array<int, 4> ModelOpenSim4::GetRealizeCounts() const
+	{
+		const auto& mbs = m_pOsimModel->getMultibodySystem();
+		return {
+			mbs.getNumRealizationsOfThisStage( SimTK::Stage::Position ),
+			mbs.getNumRealizationsOfThisStage( SimTK::Stage::Velocity ),
+			mbs.getNumRealizationsOfThisStage( SimTK::Stage::Dynamics ),
+			mbs.getNumRealizationsOfThisStage( SimTK::Stage::Acceleration )
+		};
+	}
+
+	PerfCounters ModelOpenSim4::GetPerfCounters() const
+	{
+		auto pc = Model::GetPerfCounters();
+		const auto& integ = GetTkIntegrator();
+		pc.rejected_steps = std::max( integ.getNumStepsAttempted() - integ.getNumStepsTaken(), 0 );
+		const auto counts = GetRealizeCounts();
+		for ( size_t i = 0; i < counts.size(); ++i )
+			pc.realize_calls[i] = std::max( counts[i] - m_RealizeCountsAtReset[i], 0 );
+		return pc;
+	}
+
+	void ModelOpenSim4::UpdateContactForceValues() const
+	{
+		// realize the state and check the number of realizations
+		// IMPORTANT: we use the getNumRealizationsOfThisStage() instead of time or step
+		// because FixTkState() calls this multiple times before integration
+		const auto& mbs = m_pOsimModel->getMultibodySystem();
+		const auto& s = GetTkState();
+		if ( s.getSystemStage() < SimTK::Stage::Dynamics )
+			mbs.realize( s, SimTK::Stage::Dynamics );
+		int num_dyn = mbs.getNumRealizationsOfThisStage( SimTK::Stage::Dynamics );
+
+		// update all contact forces at once, only if needed (performance)
+		if ( !cache_contact_forces || m_LastContactForceRealization != num_dyn )
+		{
+			for ( auto* cf : m_OsimContactForces )
+				cf->ComputeForceValues( s );
+			m_LastContactForceRealization = num_dyn;
+			for ( auto* b : m_ContactBodies )
+				b->UpdateContactSums();
+		}
 	}
 
 	Vec3 ModelOpenSim4::GetGravity() const
@@ -560,6 +715,8 @@ namespace scone
 
 	void ControllerDispatcher::computeControls( const SimTK::State& s, SimTK::Vector& controls ) const
 	{
+		SCONE_PROFILE_FUNCTION( m_Model->GetProfiler() );
+
 		// see 'catch' statement below for explanation try {} catch {} is needed
 		try
 		{
@@ -626,7 +783,10 @@ namespace scone
 
 		if ( use_fixed_control_step_size )
 		{
-			int number_of_steps = static_cast<int>( 0.5 + ( time - GetTime() ) / fixed_control_step_size );
+			const ScopedAllocationCount allocations;
+
+			// steps are taken at fixed_step_size; controls and analyses are updated at their own intervals
+			int number_of_steps = static_cast<int>( 0.5 + ( time - GetTime() ) / fixed_step_size );
 
 			// initialize the time-stepper if this is the first step
 			if ( !m_pTkTimeStepper && number_of_steps > 0 )
@@ -646,15 +806,20 @@ namespace scone
 			for ( int current_step = 0; current_step < number_of_steps; )
 			{
 				// update controls
-				UpdateControlValues();
+				const auto step_index = static_cast<int>( std::lround( GetTime() / fixed_step_size ) );
+				if ( step_index % fixed_control_step_interval == 0 ) {
+					UpdateControlValues();
+					m_PrevControlTime = GetTime();
+				}
 
 				// integrate
 				m_PrevTime = GetTime();
 				m_PrevIntStep = GetIntegrationStep();
-				double target_time = GetTime() + fixed_control_step_size;
+				double target_time = GetTime() + fixed_step_size;
 
 				{
 					SCONE_PROFILE_SCOPE( GetProfiler(), "SimTK::TimeStepper::stepTo" );
+					const AllocationExemption exemption;
 					auto st = xo::scoped_timer_starter( m_SimulationTimer );
 					auto status = m_pTkTimeStepper->stepTo( target_time );
 					if ( status == SimTK::Integrator::EndOfSimulation )
@@ -666,19 +831,29 @@ namespace scone
 
 				++current_step;
 
-				// Realize Acceleration, analysis components may need it
-				// this way the results are always consistent
+				// determine which consumers need the new state
+				// legacy sensor delay adapters require a frame for each step
+				const auto next_index = step_index + 1;
+				const bool update_controls = next_index % fixed_control_step_interval == 0;
+				const bool update_analyses = next_index % fixed_analysis_step_interval == 0;
+				const bool store_frame = MustStoreCurrentFrame();
+				if ( update_controls || update_analyses || store_frame || !m_SensorDelayAdapters.empty() || !realize_required_stage )
 				{
-					SCONE_PROFILE_SCOPE( GetProfiler(), "SimTK::MultibodySystem::realize" );
-					m_pOsimModel->getMultibodySystem().realize( GetTkState(), SimTK::Stage::Acceleration );
-				}
+					// realize the stage needed by the components, higher stages are realized on request
+					RealizeRequiredStage( store_frame );
 
-				// update the sensor delays, analyses, and store data
-				UpdateSensorDelayAdapters();
-				UpdateAnalyses();
+					// update the sensor delays, analyses, and store data
+					UpdateSensorDelayAdapters();
+					if ( update_analyses )
+						UpdateAnalyses();
 
-				if ( MustStoreCurrentFrame() )
-					StoreCurrentFrame();
+					if ( store_frame )
+						StoreCurrentFrame();
+
+					// none of the consumers required accelerations
+					if ( GetTkState().getSystemStage() < SimTK::Stage::Acceleration )
+						++m_RealizeStats.skipped;
+				}
 
 				// terminate when simulation has ended
 				if ( HasSimulationEnded() )
@@ -687,6 +862,7 @@ namespace scone
 					break;
 				}
 			}
+			m_AllocationCount += allocations();
 		}
 		else
 		{
@@ -723,6 +899,11 @@ namespace scone
 		return m_PrevTime;
 	}
 
+	TimeInSeconds ModelOpenSim4::GetDeltaTime() const
+	{
+		return GetTime() - m_PrevControlTime;
+	}
+
 	Real ModelOpenSim4::GetTotalEnergyConsumption() const
 	{
 		if ( m_pProbe )
@@ -857,6 +1038,7 @@ namespace scone
 
 	void ModelOpenSim4::CopyStateFromTk()
 	{
+		InvalidateBodyKinematics();
 		SCONE_ASSERT( m_State.GetSize() >= GetOsimModel().getNumStateVariables() );
 		auto osvalues = GetOsimModel().getStateVariableValues( GetTkState() );
 		for ( int i = 0; i < osvalues.size(); ++i )
@@ -865,6 +1047,7 @@ namespace scone
 
 	void ModelOpenSim4::CopyStateToTk()
 	{
+		InvalidateBodyKinematics();
 		SCONE_ASSERT( m_State.GetSize() >= GetOsimModel().getNumStateVariables() );
 		GetOsimModel().setStateVariableValues( GetTkState(),
 			SimTK::Vector( static_cast<int>( m_State.GetSize() ), &m_State.GetValues()[0] ) );
@@ -886,7 +1069,7 @@ namespace scone
 		m_State.SetValues( state.GetValues() );
 		CopyStateToTk();
 		GetTkState().setTime( timestamp );
-		m_pOsimModel->getMultibodySystem().realize( GetTkState(), SimTK::Stage::Acceleration );
+		RealizeRequiredStage( false );
 		if ( GetController() )
 			UpdateControlValues();
 	}
@@ -896,17 +1079,31 @@ namespace scone
 		m_State.SetValues( state );
 		CopyStateToTk();
 		GetTkState().setTime( timestamp );
-		m_pOsimModel->getMultibodySystem().realize( GetTkState(), SimTK::Stage::Acceleration );
+		const bool store_frame = MustStoreCurrentFrame();
+		RealizeRequiredStage( store_frame );
 		if ( GetController() )
 			UpdateControlValues();
-		if ( MustStoreCurrentFrame() )
+		if ( store_frame )
 			StoreCurrentFrame();
 	}
 
+	void ModelOpenSim4::Reset()
+	{
+		// restart the integrator from the initial state at the next simulation step
+		m_pTkTimeStepper.reset();
+		m_pTkIntegrator->resetAllStatistics();
+		m_RealizeCountsAtReset = GetRealizeCounts();
+		m_PrevIntStep = -1;
+		m_PrevTime = 0.0;
+		m_PrevControlTime = 0.0;
+		InvalidateBodyKinematics();
+		Model::Reset();
+	}
+
 	void ModelOpenSim4::InitStateFromDofs()
 	{
 		CopyStateFromTk();
-		m_pOsimModel->getMultibodySystem().realize( GetTkState(), SimTK::Stage::Acceleration );
+		RealizeRequiredStage( false );
 		InitializeController();
 	}
 
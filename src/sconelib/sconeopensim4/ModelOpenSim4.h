@@ -14,7 +14,9 @@
 #include "BodyOpenSim4.h"
 #include "MuscleOpenSim4.h"
 
+#include <array>
 #include <memory>
+#include <optional>
 
 namespace OpenSim
 {
@@ -30,6 +32,7 @@ namespace OpenSim
 namespace SimTK
 {
 	class State;
+	class Stage;
 	class Integrator;
 	class TimeStepper;
 }
@@ -69,9 +72,18 @@ namespace scone
 		/// Unsided name of the leg contact force (if any); default = foot
 		String leg_contact_force;
 
-		/// ADVANCED: use extra thread safety, required due to issue with Millard2012EquilibriumMuscle; default = 1
+		/// ADVANCED: serialize model construction using a global lock, fallback for issues with Millard2012EquilibriumMuscle; default = 0
 		bool safe_mode;
 
+		/// ADVANCED: after each step, realize only the stage required by controllers, measures and data storage, set to 0 to always realize accelerations; default = 1
+		bool realize_required_stage;
+
+		/// ADVANCED: cache whole-body kinematics (COM, momentum) per state, set to 0 to compute each query separately; default = 1
+		bool cache_body_kinematics;
+
+		/// ADVANCED: compute all contact forces at once per state, set to 0 to compute them on each query; default = 1
+		bool cache_contact_forces;
+
 		ModelOpenSim4( const PropNode& props, Params& par );
 		virtual ~ModelOpenSim4();
 
@@ -98,6 +110,8 @@ namespace scone
 
 		virtual double GetTime() const override;
 		virtual double GetPreviousTime() const override;
+		/// Time since the previous control update, which may span several integration steps.
+		virtual TimeInSeconds GetDeltaTime() const override;
 		virtual int GetIntegrationStep() const override;
 		virtual int GetPreviousIntegrationStep() const override;
 		virtual TimeInSeconds GetSimulationStepSize() override;
@@ -109,7 +123,19 @@ namespace scone
 		const SimTK::Integrator& GetTkIntegrator() const { return *m_pTkIntegrator; }
 		SimTK::State& GetTkState() { return *m_pTkState; }
 		const SimTK::State& GetTkState() const { return *m_pTkState; }
-		void SetTkState( SimTK::State& s ) { m_pTkState = &s; }
+		void SetTkState( SimTK::State& s ) { m_pTkState = &s; InvalidateBodyKinematics(); }
+
+		// update the values of all contact forces and the contact sums of all bodies if the state has changed
+		void UpdateContactForceValues() const;
+
+		// realize the state up to stage, if it is not already
+		void Realize( SimTK::Stage stage ) const;
+
+		// realize the state up to the stage required by the controller, measure and data storage
+		void RealizeRequiredStage( bool store_frame ) const;
+
+		// invalidate cached whole-body kinematics, must be called when the state is changed directly
+		void InvalidateBodyKinematics() const { m_BodyKinematics = BodyKinematics(); InvalidateRayCaster(); }
 
 		virtual const String& GetName() const override;
 
@@ -122,6 +148,7 @@ namespace scone
 		virtual const State& GetState() const override { return m_State; }
 		virtual void SetState( const State& state, TimeInSeconds timestamp ) override;
 		virtual void SetStateValues( const std::vector< Real >& state, TimeInSeconds timestamp ) override;
+		virtual void Reset() override;
 
 		virtual void SetController( ControllerUP c ) override;
 		void InitializeOpenSimMuscleActivations( double override_activation = 0.0 );
@@ -131,6 +158,8 @@ namespace scone
 
 		static String GetOpenSimVersionId();
 		virtual String GetSimulatorId() const { return GetOpenSimVersionId(); }
+		virtual std::vector<std::pair<String, std::pair<xo::time, size_t>>> GetBenchmarks() const override;
+		virtual PerfCounters GetPerfCounters() const override;
 
 	private:
 		void InitStateFromTk();
@@ -154,17 +183,44 @@ namespace scone
 		SimTK::State* m_pTkState; // non-owning state reference
 		OpenSim::Probe* m_pProbe; // owned by OpenSim::Model
 		std::vector< OpenSim::ConstantForce* > m_BodyForces;
+		std::vector< class ContactForceOpenSim4* > m_OsimContactForces;
+		std::vector< BodyOpenSim4* > m_ContactBodies; // bodies with contact forces
+		mutable int m_LastContactForceRealization;
 
 		friend ControllerDispatcher;
 		ControllerDispatcher* m_pControllerDispatcher; // owned by OpenSim::Model
 
 		State m_State; // model state
 		int m_PrevIntStep;
-		double m_PrevTime;
+		double m_PrevTime; // time of the previous integration step
+		double m_PrevControlTime; // time of the previous control update
 		TimeInSeconds m_EndTime;
 
 		// cached variables
 		Real m_Mass;
 		Real m_BW;
+
+		// whole-body kinematics, computed on first request and cached until the state or time changes
+		struct BodyKinematics {
+			double time = xo::constantsd::NaN();
+			std::optional<Vec3> com_pos;
+			std::optional<Vec3> com_vel;
+			std::optional<Vec3> com_acc;
+			std::optional<std::pair<Vec3, Vec3>> lin_ang_mom;
+		};
+		BodyKinematics& UpdBodyKinematics() const;
+		mutable BodyKinematics m_BodyKinematics;
+
+		// statistics of realizations to the Acceleration stage, used for benchmarks
+		struct RealizeStats {
+			xo::timer timer = xo::timer( false );
+			size_t count = 0; // number of realizations to Acceleration
+			size_t skipped = 0; // number of updated steps that did not require Acceleration
+		};
+		mutable RealizeStats m_RealizeStats;
+
+		// number of realizations per SimulationStage at the last Reset(), used for performance counters
+		std::array<int, 4> GetRealizeCounts() const;
+		std::array<int, 4> m_RealizeCountsAtReset;
 	};
 }
@@ -269,7 +269,9 @@ PYBIND11_MODULE( sconepy, m ) {
 		.def( "has_custom_value", &scone::Model::HasCustomValue, "Check if a custom value exists" )
 		.def( "get_custom_value_names", &scone::Model::GetCustomValueNames, "Get a list of all custom values in this Model" )
 		.def( "get_ray_distance", &scone::get_ray_distance, "Get the distance of a ray cast with a position and direction, up unit max_dist" )
+		.def( "get_ray_distances", &scone::get_ray_distances, "Get the distances of multiple ray casts with (n, 3) arrays of positions and directions, up until max_dist" )
 		.def( "integration_step", &scone::Model::GetIntegrationStep, "Get the integration step of this Model" )
+		.def( "perf_counters", &scone::get_perf_counters, "Get a dict with performance counters of the current simulation (steps, realizations, timings [s], delay buffer memory [bytes])" )
 		.def( "control_step_size", []( scone::Model& m ) { return m.fixed_control_step_size; }, "Get the control step size [s] of this Model" )
 		.def( "set_store_data", &scone::Model::SetStoreData, "Set if data must be stored during Model simulation (slow, do not use in optimizations)" )
 		.def( "get_store_data", &scone::Model::GetStoreData, "Get if data is stored during Model simulation" )
@@ -84,6 +84,13 @@ namespace scone
 		return dict;
 	};
 
+	std::map< std::string, double > get_perf_counters( const Model& model ) {
+		std::map< std::string, double > dict;
+		for ( const auto& [name, value] : model.GetPerfCounters().GetValues() )
+			dict[name] = value;
+		return dict;
+	}
+
 	void set_state( Model& model, const std::map< std::string, double >& dict ) {
 		State s = model.GetState();
 		for ( auto& [key, value] : dict )
@@ -246,6 +253,22 @@ namespace scone
 		return model.GetRayIntersection( pos, dir, max_dist ).first;
 	}
 
+	py::array_t<double> get_ray_distances( Model& model, const py::array_t<double>& pos, const py::array_t<double>& dir, double max_dist ) {
+		auto p = pos.unchecked<2>();
+		auto d = dir.unchecked<2>();
+		const auto n = size_t( p.shape( 0 ) );
+		check_array_length( n, d.shape( 0 ) );
+		SCONE_ERROR_IF( p.shape( 1 ) != 3 || d.shape( 1 ) != 3, "Ray positions and directions must be arrays of shape (n, 3)" );
+		std::vector<Vec3> pv( n ), dv( n );
+		for ( index_t i = 0; i < n; ++i ) {
+			pv[i] = Vec3( p( i, 0 ), p( i, 1 ), p( i, 2 ) );
+			dv[i] = Vec3( d( i, 0 ), d( i, 1 ), d( i, 2 ) );
+		}
+		auto [v, r] = make_array<double>( n );
+		model.GetRayDistances( pv.data(), dv.data(), n, max_dist, r );
+		return v;
+	}
+
 	fs::path to_fs( const xo::path& p ) { return fs::path( p.str() ); }
 	xo::path from_fs( const fs::path& p ) { return xo::path( p.string() ); }
 
@@ -0,0 +1,44 @@
+/*
+** allocation_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/sconelib_config.h"
+#include "scone/core/AllocationTracker.h"
+#include "scone/core/Benchmark.h"
+#include "scone/core/Log.h"
+#include "scone/core/system_tools.h"
+#include "scone/optimization/opt_tools.h"
+
+#include "xo/system/test_case.h"
+
+using namespace scone;
+
+namespace
+{
+	void check_steady_state_allocations( const path& file )
+	{
+		for ( const auto& [scope, count] : CountSteadyStateAllocations( LoadScenario( file ), file, 2.0 ) )
+			XO_CHECK_MESSAGE( false, file.filename().str() + ": " + scope + ": " + to_str( count ) + " allocations" );
+	}
+}
+
+// Steady-state simulation steps must not allocate, except at exempt call sites of the external simulator.
+// CI runs this test in a separate build with SCONE_ALLOCATION_TRACKING.
+XO_TEST_CASE( allocation_test )
+{
+	if ( !IsAllocationTrackingAvailable() ) {
+		log::warning( "allocation_test skipped, requires a build with SCONE_ALLOCATION_TRACKING" );
+		return;
+	}
+
+#if SCONE_OPENSIM_3_ENABLED
+	check_steady_state_allocations( GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone" );
+#endif
+#if SCONE_OPENSIM_4_ENABLED
+	check_steady_state_allocations( GetInstallFolder() / "scenarios/Examples/Gait - H0918 - OpenSim4.scone" );
+#endif
+}
@@ -0,0 +1,385 @@
+/*
+** evaluation_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/sconelib_config.h"
+#include "scone/core/Benchmark.h"
+#include "scone/core/CounterRng.h"
+#include "scone/core/Log.h"
+#include "scone/core/ParallelReduce.h"
+#include "scone/core/StorageIo.h"
+#include "scone/core/system_tools.h"
+#include "scone/model/GaitTracker.h"
+#include "scone/model/Leg.h"
+#include "scone/optimization/opt_tools.h"
+#include "scone/optimization/ParamBindingPlan.h"
+#include "test_tools.h"
+
+#include "xo/filesystem/filesystem.h"
+#include "xo/serialization/prop_node_serializer_zml.h"
+#include "xo/system/test_case.h"
+#include "xo/time/timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <numeric>
+#include <utility>
+
+using namespace scone;
+
+namespace
+{
+	using Lookups = std::vector< std::pair< String, OptionalPar > >;
+
+	// search point that keeps a list of all parameter lookups and their results
+	template< typename Base > struct LookupRecorder : public Base
+	{
+		template< typename... Args > LookupRecorder( Args&&... args ) : Base( std::forward<Args>( args )... ) {}
+		OptionalPar try_get( const String& full_name ) const override {
+			auto value = Base::try_get( full_name );
+			lookups.emplace_back( full_name, value );
+			return value;
+		}
+		mutable Lookups lookups;
+	};
+
+	bool same_lookups( const Lookups& a, const Lookups& b ) {
+		return std::equal( a.begin(), a.end(), b.begin(), b.end(), []( const auto& la, const auto& lb ) {
+			return la.first == lb.first && bool( la.second ) == bool( lb.second ) && ( !la.second || *la.second == *lb.second );
+		} );
+	}
+
+	bool same_data( const Storage<>& a, const Storage<>& b ) {
+		if ( a.GetLabels() != b.GetLabels() || a.GetFrameCount() != b.GetFrameCount() )
+			return false;
+		for ( index_t f = 0; f < a.GetFrameCount(); ++f )
+			if ( a.GetFrame( f ).GetTime() != b.GetFrame( f ).GetTime() || a.GetFrame( f ).GetValues() != b.GetFrame( f ).GetValues() )
+				return false;
+		return true;
+	}
+}
+
+XO_TEST_CASE( counter_rng_test )
+{
+	// bulk generation must give the same values as individual samples
+	CounterRng rng( 123 );
+	for ( size_t n : { 1, 2, 7, 8, 9, 33 } ) {
+		std::vector<double> values( n );
+		rng.fill_normal( 42, values );
+		for ( size_t i = 0; i < n; ++i )
+			XO_CHECK( values[i] == rng.normal( 42, i ) );
+	}
+}
+
+// Counter-based motor noise must not depend on the number of concurrent evaluations.
+XO_TEST_CASE( noise_controller_thread_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 3b - Motor Noise Balance - OpenSim.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "NoiseController", "use_counter_rng", true );
+	set_child_props( scenario_pn, "SimulationObjective", "max_duration", 2.0 );
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	SearchPoint point( mo->info() );
+
+	const auto reference = evaluate_point( *mo, point );
+	for ( size_t thread_count : { 2, 4, 8 } )
+		for ( auto fitness : evaluate_point_concurrently( *mo, point, thread_count ) )
+			XO_CHECK_MESSAGE( fitness == reference, stringf( "threads=%zu: %.17g != %.17g", thread_count, fitness, reference ) );
+#endif
+}
+
+// Model construction with a replayed ParamBindingPlan must perform the same lookups with the same results.
+XO_TEST_CASE( param_binding_plan_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto scenario_pn = LoadScenario( file );
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	SearchPoint point( mo->info() );
+
+	LookupRecorder< SearchPoint > regular( point );
+	mo->CreateModelFromParams( regular );
+
+	ParamBindingPlan plan;
+	LookupRecorder< BindingSearchPoint > record( point, plan );
+	mo->CreateModelFromParams( record );
+	XO_CHECK( plan.bindings.size() == regular.lookups.size() );
+
+	LookupRecorder< BindingSearchPoint > replay( point, std::as_const( plan ) );
+	mo->CreateModelFromParams( replay );
+	XO_CHECK( replay.IsReplayValid() );
+	XO_CHECK( replay.GetReplayCount() == plan.bindings.size() );
+	XO_CHECK( same_lookups( record.lookups, regular.lookups ) );
+	XO_CHECK( same_lookups( replay.lookups, regular.lookups ) );
+
+	// measure the lookup time with and without plan, without the cost of model construction
+	const int repeats = 100;
+	xo::timer t;
+	for ( int i = 0; i < repeats; ++i ) {
+		SearchPoint sp( point );
+		for ( const auto& lookup : regular.lookups )
+			sp.try_get( lookup.first );
+	}
+	auto regular_time = t().secondsd();
+	for ( int i = 0; i < repeats; ++i ) {
+		BindingSearchPoint sp( point, std::as_const( plan ) );
+		for ( const auto& lookup : regular.lookups )
+			sp.try_get( lookup.first );
+	}
+	auto replay_time = t().secondsd() - regular_time;
+	log::info( stringf( "%zu parameter lookups: regular=%.3fus replay=%.3fus", regular.lookups.size(),
+		1e6 * regular_time / repeats, 1e6 * replay_time / repeats ) );
+#endif
+}
+
+// A re-parameterized model must give the same fitness as a model that is created for the same point.
+XO_TEST_CASE( reuse_models_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "SimulationObjective", "max_duration", 1.0 );
+	set_child_props( scenario_pn, "ModelOpenSim3", "initial_state_offset", 0 ); // no free model parameters
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+
+	set_child_props( scenario_pn, "SimulationObjective", "reuse_models", true );
+	auto reuse_mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	XO_CHECK( reuse_mo->CanReuseModels() );
+
+	SearchPoint point_a( mo->info() );
+	auto values_b = point_a.values();
+	for ( auto& v : values_b )
+		v *= 1.1;
+	SearchPoint point_b( mo->info(), values_b );
+
+	const auto fitness_a = evaluate_point( *mo, point_a );
+	const auto fitness_b = evaluate_point( *mo, point_b );
+	XO_CHECK( evaluate_point( *reuse_mo, point_a ) == fitness_a ); // creates the model
+	XO_CHECK( evaluate_point( *reuse_mo, point_b ) == fitness_b ); // re-parameterizes the model
+	XO_CHECK( evaluate_point( *reuse_mo, point_a ) == fitness_a );
+#endif
+}
+
+// Evaluations found in the evaluation cache must be counted as cached, without adding simulated time.
+XO_TEST_CASE( evaluation_cache_counters_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "SimulationObjective", "max_duration", 0.5 );
+	set_child_props( scenario_pn, "SimulationObjective", "use_evaluation_cache", true );
+	set_child_props( scenario_pn, "SimulationObjective", "evaluation_cache_file",
+		xo::create_unique_directory( xo::temp_directory_path() / "SCONE/evaluation_cache_counters_test" ) / "evaluation_cache.txt" );
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	SearchPoint point( mo->info() );
+
+	const auto fitness = evaluate_point( *mo, point );
+	const auto simulated_time = mo->GetSimulatedTime();
+	XO_CHECK( simulated_time > 0 );
+	XO_CHECK( evaluate_point( *mo, point ) == fitness );
+	XO_CHECK( mo->GetSimulatedTime() == simulated_time );
+	const auto pc = mo->TakePerfCounters();
+	XO_CHECK( pc.simulations == 1 );
+	XO_CHECK( pc.cached_evaluations == 1 );
+#endif
+}
+
+// Explicit control and measure step sizes must give the same fitness as the default when all rates are equal,
+// and a smaller measure step size must not change the integration step unless multi-rate stepping is enabled.
+XO_TEST_CASE( step_rate_test )
+{
+#if SCONE_OPENSIM_4_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Examples/Gait - H0918 - OpenSim4.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "SimulationObjective", "max_duration", 1.0 );
+	auto evaluate_with = [&]( double measure_step_size, bool multi_rate ) {
+		auto pn = scenario_pn;
+		set_child_props( pn, "ModelOpenSim4", "fixed_control_step_size", 0.001 );
+		set_child_props( pn, "ModelOpenSim4", "fixed_measure_step_size", measure_step_size );
+		set_child_props( pn, "ModelOpenSim4", "use_multi_rate_stepping", multi_rate );
+		auto mo = CreateModelObjective( pn, file.parent_path() );
+		return evaluate_point( *mo, SearchPoint( mo->info() ) );
+	};
+
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	const auto reference = evaluate_point( *mo, SearchPoint( mo->info() ) );
+	XO_CHECK( evaluate_with( 0.001, false ) == reference );
+	XO_CHECK( evaluate_with( 0.001, true ) == reference );
+	XO_CHECK( evaluate_with( 0.0005, false ) == reference );
+#endif
+}
+
+// Realizing only the required stage and caching kinematics and contact forces per state must not change results.
+XO_TEST_CASE( state_cache_test )
+{
+#if SCONE_OPENSIM_4_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Examples/Gait - H0918 - OpenSim4.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "SimulationObjective", "max_duration", 1.0 );
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	SearchPoint point( mo->info() );
+	auto simulate = [&]( const ModelObjective& obj, bool store_data ) {
+		SearchPoint model_point( point );
+		auto model = obj.CreateModelFromParams( model_point );
+		model->SetStoreData( store_data );
+		model->AdvanceSimulationTo( 0.5 );
+		return model;
+	};
+	auto saved_seconds = []( const Model& model ) {
+		for ( const auto& [name, bm] : model.GetBenchmarks() )
+			if ( name == "RealizeAccelerationSaved" )
+				return bm.first.secondsd();
+		return 0.0;
+	};
+
+	const auto reference = evaluate_point( *mo, point );
+	const auto reference_model = simulate( *mo, true );
+	XO_CHECK( saved_seconds( *simulate( *mo, false ) ) > 0.0 ); // no component of the scenario requires accelerations
+	for ( String key : { "realize_required_stage", "cache_body_kinematics", "cache_contact_forces" } ) {
+		auto pn = scenario_pn;
+		set_child_props( pn, "ModelOpenSim4", key, false );
+		auto uncached_mo = CreateModelObjective( pn, file.parent_path() );
+		XO_CHECK_MESSAGE( evaluate_point( *uncached_mo, point ) == reference, key );
+		XO_CHECK_MESSAGE( same_data( simulate( *uncached_mo, true )->GetData(), reference_model->GetData() ), key );
+		if ( key == "realize_required_stage" )
+			XO_CHECK( saved_seconds( *simulate( *uncached_mo, false ) ) == 0.0 );
+	}
+#endif
+}
+
+// GaitTracker must detect the same new foot contacts as GaitMeasure::HasNewFootContact() did before it.
+XO_TEST_CASE( gait_tracker_test )
+{
+#if SCONE_OPENSIM_4_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Examples/Gait - H0918 - OpenSim4.scone";
+	auto mo = CreateModelObjective( LoadScenario( file ), file.parent_path() );
+	SearchPoint point( mo->info() );
+	auto model = mo->CreateModelFromParams( point );
+	const Real load_threshold = 0.1;
+	auto& tracker = model->GetGaitTracker();
+	const auto detector = tracker.AddContactDetector( load_threshold );
+
+	std::vector<bool> prev_contact;
+	size_t new_contact_count = 0;
+	for ( int i = 1; i <= 300 && !model->HasSimulationEnded(); ++i ) {
+		model->AdvanceSimulationTo( i * 0.005 );
+
+		// reference implementation, the first update only initializes the contact state
+		bool new_contact = false;
+		for ( index_t idx = 0; idx < model->GetLegCount(); ++idx ) {
+			const bool contact = model->GetLeg( idx ).GetLoad() >= load_threshold;
+			if ( prev_contact.size() < model->GetLegCount() )
+				prev_contact.push_back( contact );
+			else {
+				new_contact |= contact && !prev_contact[idx];
+				prev_contact[idx] = contact;
+			}
+		}
+		new_contact_count += new_contact;
+
+		XO_CHECK_MESSAGE( tracker.UpdateContactDetector( *model, detector ) == new_contact, stringf( "t=%g", model->GetTime() ) );
+		for ( index_t idx = 0; idx < model->GetLegCount(); ++idx ) {
+			const auto& leg = model->GetLeg( idx );
+			XO_CHECK( tracker.GetLegLoad( idx ) == leg.GetLoad() );
+			XO_CHECK( tracker.HasContact( detector, idx ) == ( leg.GetLoad() >= load_threshold ) );
+			XO_CHECK( tracker.GetLegForceValue( idx ) == leg.GetContactForceValue() );
+		}
+	}
+	XO_CHECK( new_contact_count >= 2 ); // otherwise the simulation is not suitable for this test
+#endif
+}
+
+// Chunked reductions must not depend on the number of chunks or threads; summing per-chunk partial sums would.
+XO_TEST_CASE( parallel_reduction_test )
+{
+	const size_t n = 1000;
+	std::vector<double> values( n );
+	for ( size_t i = 0; i < n; ++i )
+		values[i] = ( i % 7 + 1 ) * std::pow( 10.0, int( i * 37 % 17 ) - 8 ) * ( i % 2 ? -1 : 1 );
+	const auto reference = TreeSum( values );
+	const auto sequential = std::accumulate( values.begin(), values.end(), 0.0 );
+
+	bool naive_sum_differs = false;
+	for ( size_t threads = 1; threads <= 8; ++threads ) {
+		// divide values into one chunk per thread
+		auto chunks = ParallelMap( threads, [&]( size_t c ) {
+			return std::vector<double>( values.begin() + c * n / threads, values.begin() + ( c + 1 ) * n / threads );
+		}, threads );
+		std::vector<double> joined;
+		double naive_sum = 0.0;
+		for ( const auto& chunk : chunks ) {
+			joined.insert( joined.end(), chunk.begin(), chunk.end() );
+			naive_sum += std::accumulate( chunk.begin(), chunk.end(), 0.0 );
+		}
+		XO_CHECK_MESSAGE( TreeSum( joined ) == reference, stringf( "threads=%zu", threads ) );
+		naive_sum_differs |= naive_sum != sequential;
+	}
+	XO_CHECK( naive_sum_differs ); // otherwise the values are not suitable for this test
+}
+
+// Imitation divided into chunks must give the same fitness for any number of threads.
+XO_TEST_CASE( imitation_determinism_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/UnitTests/OpenSim3/Jump - Imitation.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "ImitationObjective", "evaluation_chunks", 4 );
+	for ( size_t threads : { 2, 3, 5 } )
+		XO_CHECK_MESSAGE( CheckEvaluationDeterminism( scenario_pn, file, threads ), stringf( "threads=%zu", threads ) );
+#endif
+}
+
+// Chunked imitation of a controller with internal state must not depend on the number of threads either.
+XO_TEST_CASE( imitation_controller_state_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	// the recording and model are written to a temporary folder, where ImitationObjective can find them
+	const auto folder = xo::path( ( std::filesystem::temp_directory_path() / "scone_imitation_controller_state_test" ).string() );
+	std::filesystem::create_directories( folder.str() );
+	std::filesystem::copy_file( ( GetInstallFolder() / "scenarios/UnitTests/OpenSim3/data/Human0914.osim" ).str(),
+		( folder / "Human0914.osim" ).str(), std::filesystem::copy_options::overwrite_existing );
+
+	// the low-pass filter of the reflex keeps state between frames
+	const String model_and_controller = "OpenSimModel { model_file = Human0914.osim } "
+		"ReflexController { DofReflex { target = vasti source = knee_angle delay = 0.01 KP = 1 KV = 0.1 filter_cutoff_frequency = 10 } }";
+	auto sim_mo = CreateModelObjective( xo::parse_zml( ( "CmaOptimizer { SimulationObjective { max_duration = 0.5 " + model_and_controller + " } }" ).c_str() ), folder );
+	SearchPoint sim_point( sim_mo->info() );
+	auto model = sim_mo->CreateModelFromParams( sim_point );
+	model->SetStoreData( true );
+	model->AdvanceSimulationTo( 0.5 );
+
+	// record the delayed sensor values, which are read by ImitationObjective
+	auto sto = model->GetData();
+	const auto& ds = model->GetSensorDelayStorage();
+	for ( index_t c = 0; c < ds.GetChannelCount(); ++c ) {
+		auto idx = sto.TryGetChannelIndex( ds.GetLabels()[c] );
+		if ( idx == NoIndex )
+			idx = sto.AddChannel( ds.GetLabels()[c] );
+		for ( index_t f = 0; f < sto.GetFrameCount(); ++f )
+			sto.GetFrame( f )[idx] = ds.GetClosestFrame( sto.GetFrame( f ).GetTime() )[c];
+	}
+	WriteStorageSto( sto, folder / "imitation.sto", "imitation_controller_state_test" );
+
+	auto imitation_pn = [&]( int chunks ) {
+		const auto str = stringf( "CmaOptimizer { ImitationObjective { file = imitation.sto evaluation_chunks = %d ", chunks ) + model_and_controller + " } }";
+		return xo::parse_zml( str.c_str() );
+	};
+	const auto file = folder / "imitation.scone"; // only used to find the files
+	for ( size_t threads : { 2, 3, 5 } )
+		XO_CHECK_MESSAGE( CheckEvaluationDeterminism( imitation_pn( 4 ), file, threads ), stringf( "threads=%zu", threads ) );
+
+	// the number of chunks cannot depend on the number of threads
+	bool zero_chunks_error = false;
+	try { CreateModelObjective( imitation_pn( 0 ), folder ); }
+	catch ( std::exception& ) { zero_chunks_error = true; }
+	XO_CHECK( zero_chunks_error );
+
+	std::filesystem::remove_all( folder.str() );
+#endif
+}
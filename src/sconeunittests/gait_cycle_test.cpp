@@ -0,0 +1,178 @@
+/*
+** gait_cycle_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/core/GaitCycle.h"
+#include "scone/core/StorageIo.h"
+#include "scone/core/system_tools.h"
+
+#include "xo/numerical/constants.h"
+#include "xo/system/test_case.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace scone;
+
+namespace
+{
+	// gait.sto has left touch downs at 0.05 + k, right touch downs at 0.55 + k and a stance of 0.6 s;
+	// the left foot has a bump at 1.80 - 1.81, which must be merged with the cycle starting at 1.05
+	xo::path gait_file() { return GetFolder( SconeFolder::Root ) / "resources/unittestdata/gait_cycle_test/gait.sto"; }
+	GaitCycleExtractionSettings gait_settings() { return GaitCycleExtractionSettings{ 0.1, 0.1 }; }
+
+	// frame-based implementation of ExtractGaitCycles() before GaitCycleExtractor, used as reference
+	index_t find_next_touch( const Storage<>& sto, index_t idx, const index_t channel_idx, const Real threshold ) {
+		while ( idx != no_index && idx < sto.GetFrameCount() && sto.GetFrame( idx )[channel_idx] <= threshold ) idx++;
+		return idx < sto.GetFrameCount() ? idx : no_index;
+	}
+
+	index_t find_next_flight( const Storage<>& sto, index_t idx, const index_t channel_idx, const Real threshold ) {
+		while ( idx != no_index && idx < sto.GetFrameCount() && sto.GetFrame( idx )[channel_idx] > threshold ) idx++;
+		return idx < sto.GetFrameCount() ? idx : no_index;
+	}
+
+	std::vector<GaitCycle> reference_gait_cycles( const Storage<>& sto, const GaitCycleExtractionSettings& opt ) {
+		std::vector<GaitCycle> cycles;
+		for ( auto side : { Side::Left, Side::Right } ) {
+			String leg_name = ( side == Side::Left ) ? "leg0_l" : "leg1_r";
+			index_t grf_chan = sto.TryGetChannelIndex( leg_name + ".grf_norm_y" );
+			index_t cop_chan = sto.TryGetChannelIndex( leg_name + ".cop_x" );
+			index_t flight_idx = find_next_flight( sto, 0u, grf_chan, opt.touch_force_threshold );
+			index_t touch_idx = find_next_touch( sto, flight_idx, grf_chan, opt.touch_force_threshold );
+			while ( touch_idx != no_index && touch_idx < sto.GetFrameCount() ) {
+				auto begin_time = sto.GetFrame( touch_idx ).GetTime();
+				auto begin_pos = sto.GetFrame( touch_idx ).GetVec3( cop_chan );
+				flight_idx = find_next_flight( sto, touch_idx, grf_chan, opt.touch_force_threshold );
+				if ( flight_idx == no_index )
+					break;
+				auto swing_time = sto.GetFrame( flight_idx ).GetTime();
+				touch_idx = find_next_touch( sto, flight_idx, grf_chan, opt.touch_force_threshold );
+				if ( touch_idx == no_index )
+					break;
+				auto end_time = sto.GetFrame( touch_idx ).GetTime();
+				auto end_pos = sto.GetFrame( touch_idx ).GetVec3( cop_chan );
+				if ( swing_time - begin_time < opt.min_swing_duraction ) {
+					if ( !cycles.empty() && cycles.back().side_ == side ) {
+						cycles.back().end_ = end_time;
+						cycles.back().end_pos_ = end_pos;
+					}
+				}
+				else cycles.emplace_back( GaitCycle{ side, begin_time, swing_time, end_time, begin_pos, end_pos } );
+			}
+		}
+		std::sort( cycles.begin(), cycles.end(), []( auto&& a, auto&& b ) { return a.begin_ < b.begin_; } );
+		for ( int i = 1; i < cycles.size(); ++i ) {
+			for ( int j = i - 1; j > 0; --j ) {
+				if ( cycles[i].side_ != cycles[j].side_ ) {
+					cycles[i].opposite_end_pos_ = cycles[j].end_pos_;
+					break;
+				}
+			}
+		}
+		return cycles;
+	}
+
+	bool is_near( Real a, Real b, Real eps = 1e-9 ) { return std::abs( a - b ) < eps; }
+	bool is_equal( const Vec3& a, const Vec3& b ) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+}
+
+// The streaming extractor must find the known cycles of gait.sto, identical to the frame-based implementation.
+XO_TEST_CASE( gait_cycle_extraction_test )
+{
+	Storage<> sto;
+	ReadStorage( sto, gait_file() );
+	const auto cycles = ExtractGaitCycles( sto, gait_settings() );
+
+	struct ExpectedCycle { Side side; TimeInSeconds begin, swing, end; Real begin_x, end_x; };
+	const ExpectedCycle expected[] = {
+		{ Side::Left, 0.05, 0.65, 1.05, 0.06, 1.26 },
+		{ Side::Right, 0.55, 1.15, 1.55, 0.66, 1.86 },
+		{ Side::Left, 1.05, 1.65, 2.05, 1.26, 2.46 }, // includes the bump at 1.80
+		{ Side::Right, 1.55, 2.15, 2.55, 1.86, 3.06 },
+		{ Side::Left, 2.05, 2.65, 3.05, 2.46, 3.66 },
+		{ Side::Right, 2.55, 3.15, 3.55, 3.06, 4.26 },
+	};
+	XO_CHECK( cycles.size() == std::size( expected ) );
+	for ( index_t i = 0; i < cycles.size() && i < std::size( expected ); ++i ) {
+		const auto& c = cycles[i];
+		const auto& e = expected[i];
+		XO_CHECK_MESSAGE( c.side_ == e.side && is_near( c.begin_, e.begin ) && is_near( c.swing_, e.swing ) && is_near( c.end_, e.end )
+			&& is_near( c.begin_pos_.x, e.begin_x ) && is_near( c.end_pos_.x, e.end_x ), xo::to_str( c ) );
+	}
+
+	const auto reference = reference_gait_cycles( sto, gait_settings() );
+	XO_CHECK( cycles.size() == reference.size() );
+	for ( index_t i = 0; i < cycles.size() && i < reference.size(); ++i ) {
+		const auto& c = cycles[i];
+		const auto& r = reference[i];
+		XO_CHECK_MESSAGE( c.side_ == r.side_ && c.begin_ == r.begin_ && c.swing_ == r.swing_ && c.end_ == r.end_
+			&& is_equal( c.begin_pos_, r.begin_pos_ ) && is_equal( c.end_pos_, r.end_pos_ ) && is_equal( c.opposite_end_pos_, r.opposite_end_pos_ ),
+			xo::to_str( c ) + " != " + xo::to_str( r ) );
+	}
+}
+
+// Channels resampled to 0-100% gait cycle must be averaged over all cycles of a side.
+XO_TEST_CASE( gait_cycle_normalization_test )
+{
+	std::unique_ptr<GaitCycleExtractor> gce;
+	size_t callback_count = 0;
+	ReadStorageFrames( gait_file(),
+		[&]( const std::vector<String>& labels ) {
+			gce = std::make_unique<GaitCycleExtractor>( labels, gait_settings(), std::vector<String>{ "wave_l", "wave_r" }, 101 );
+			gce->SetCycleFunction( [&]( const GaitCycle& c, const std::vector<Real>& data ) {
+				XO_CHECK( data.size() == 101 * 2 );
+				++callback_count;
+			} );
+		},
+		[&]( TimeInSeconds t, const std::vector<Real>& values ) { gce->AddFrame( t, values.data() ); } );
+	gce->Finish();
+	XO_CHECK( callback_count == 6 );
+
+	// wave_l is a sine with the period of the left gait cycle, starting at left touch down
+	for ( auto side : { Side::Left, Side::Right } ) {
+		XO_CHECK( gce->GetNormalizedCycleCount( side ) == 3 );
+		const auto stats = gce->GetNormalizedStatistics( side );
+		XO_CHECK( stats.GetFrameCount() == 101 );
+		const auto chan = stats.GetChannelIndex( side == Side::Left ? "wave_l" : "wave_r" );
+		const auto std_chan = stats.GetChannelIndex( side == Side::Left ? "wave_l.std" : "wave_r.std" );
+		for ( index_t i = 0; i < stats.GetFrameCount(); i += 25 ) {
+			const auto& f = stats.GetFrame( i );
+			XO_CHECK( is_near( f.GetTime(), i ) );
+			XO_CHECK_MESSAGE( is_near( f[chan], std::sin( 2 * xo::constantsd::pi() * i / 100 ), 1e-6 ), stringf( "%zu: %g", i, f[chan] ) );
+			XO_CHECK( is_near( f[std_chan], 0, 1e-6 ) );
+		}
+	}
+}
+
+// Reading frames one by one must give the same data as reading a Storage, and malformed values must be an error.
+XO_TEST_CASE( read_storage_frames_test )
+{
+	Storage<> sto;
+	ReadStorage( sto, gait_file() );
+	index_t frame_idx = 0;
+	bool frames_equal = true;
+	ReadStorageFrames( gait_file(),
+		[&]( const std::vector<String>& labels ) { XO_CHECK( labels == sto.GetLabels() ); },
+		[&]( TimeInSeconds t, const std::vector<Real>& values ) {
+			const auto& f = sto.GetFrame( frame_idx++ );
+			frames_equal &= t == f.GetTime() && values == f.GetValues();
+		} );
+	XO_CHECK( frame_idx == sto.GetFrameCount() );
+	XO_CHECK( frames_equal );
+
+	auto malformed_file = xo::path( ( std::filesystem::temp_directory_path() / "scone_malformed_storage.sto" ).string() );
+	std::ofstream( malformed_file.str() ) << "malformed\nendheader\ntime\ta\tb\n0.0\t1\t2\n0.1\t1\n";
+	bool malformed_error = false;
+	try { ReadStorageFrames( malformed_file, []( const auto& ) {}, []( auto, const auto& ) {} ); }
+	catch ( std::exception& ) { malformed_error = true; }
+	XO_CHECK( malformed_error );
+	std::filesystem::remove( malformed_file.str() );
+}
@@ -0,0 +1,142 @@
+/*
+** lua_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/sconelib_config.h"
+#include "scone/core/Factories.h"
+#include "scone/core/Storage.h"
+#include "scone/core/system_tools.h"
+#include "scone/measures/Measure.h"
+#include "scone/model/Actuator.h"
+#include "scone/optimization/opt_tools.h"
+#include "test_tools.h"
+
+#include "xo/filesystem/filesystem.h"
+#include "xo/system/test_case.h"
+
+using namespace scone;
+
+// Changes made by one script must not be visible to scripts that reuse its pooled Lua state.
+XO_TEST_CASE( lua_state_isolation_test )
+{
+#if SCONE_LUA_ENABLED && SCONE_OPENSIM_3_ENABLED
+	auto dir = xo::temp_directory_path();
+	auto script_a = dir / "scone_lua_state_test_a.lua";
+	auto script_b = dir / "scone_lua_state_test_b.lua";
+	xo::save_string( script_a,
+		"function init( model, par, side )\n"
+		"	print = nil\n"
+		"	math.pi = 3\n"
+		"	string.upper = function( s ) return s end\n"
+		"	math.randomseed( 123 )\n"
+		"	added_global = true\n"
+		"end\n"
+		"function result( model ) return 0 end\n" );
+	xo::save_string( script_b,
+		"function result( model )\n"
+		"	if print == nil or math.pi < 3.14 or string.upper( 'a' ) ~= 'A' or added_global ~= nil then return -1 end\n"
+		"	return math.random()\n"
+		"end\n" );
+
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 6a - Script - Body Height - OpenSim.scone";
+	auto scenario_pn = LoadScenario( file );
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	SearchPoint point( mo->info() );
+	auto model = mo->CreateModelFromParams( point );
+
+	auto script_result = [&]( const path& script_file ) {
+		PropNode pn;
+		pn.set( "type", "ScriptMeasure" );
+		pn.set( "script_file", script_file );
+		auto measure = CreateMeasure( pn, point, *model, Location() );
+		return measure->GetResult( *model );
+	};
+
+	// measures are created one after another on this thread, so they share the same Lua state
+	auto result_b1 = script_result( script_b );
+	script_result( script_a );
+	auto result_b2 = script_result( script_b );
+	XO_CHECK( result_b1 >= 0 );
+	XO_CHECK_MESSAGE( result_b1 == result_b2, stringf( "%.17g != %.17g", result_b1, result_b2 ) );
+#endif
+}
+
+// Channel handles, bulk getters and index lookups must match the per-item accessors of the Lua API.
+XO_TEST_CASE( lua_api_test )
+{
+#if SCONE_LUA_ENABLED && SCONE_OPENSIM_3_ENABLED
+	auto script_file = xo::temp_directory_path() / "scone_lua_api_test.lua";
+	xo::save_string( script_file,
+		"function result( model )\n"
+		"	local errors = 0\n"
+		"	local pos, vel, act, exc = {}, {}, {}, {}\n"
+		"	model:get_dof_positions( pos )\n"
+		"	model:get_dof_velocities( vel )\n"
+		"	model:get_muscle_activations( act )\n"
+		"	model:get_muscle_excitations( exc )\n"
+		"	if #pos ~= model:dof_count() or #vel ~= model:dof_count() then errors = errors + 1 end\n"
+		"	if #act ~= model:muscle_count() or #exc ~= model:muscle_count() then errors = errors + 1 end\n"
+		"	for i = 1, model:dof_count() do\n"
+		"		local d = model:dof( i )\n"
+		"		if pos[ i ] ~= d:position() or vel[ i ] ~= d:velocity() then errors = errors + 1 end\n"
+		"		if model:find_dof_index( d:name() ) ~= i then errors = errors + 1 end\n"
+		"	end\n"
+		"	for i = 1, model:muscle_count() do\n"
+		"		local m = model:muscle( i )\n"
+		"		if act[ i ] ~= m:activation() or exc[ i ] ~= m:excitation() then errors = errors + 1 end\n"
+		"		if model:find_muscle_index( m:name() ) ~= i then errors = errors + 1 end\n"
+		"	end\n"
+		"	for i = 1, model:actuator_count() do\n"
+		"		if model:find_actuator_index( model:actuator( i ):name() ) ~= i then errors = errors + 1 end\n"
+		"	end\n"
+		"	if model:find_actuator_index( 'no_such_actuator' ) ~= 0 then errors = errors + 1 end\n"
+		"	model:add_actuator_inputs( { 0.25, nil, 0.5 } )\n"
+		"	return errors\n"
+		"end\n"
+		"function store_data( frame )\n"
+		"	local h = frame:channel( 'value' )\n"
+		"	frame:set_channel( h, 2 )\n"
+		"	frame:set_channel( frame:channel( 'nil_value' ), nil )\n"
+		"	frame:set_channel_vec3( frame:channel_vec3( 'vel' ), vec3:new( 1, 2, 3 ) )\n"
+		"	frame:set_bool( 'vec3_error', not pcall( frame.channel_vec3, frame, 'pos' ) )\n"
+		"	frame:set_bool( 'handle_error', not pcall( frame.set_channel, frame, 1000, 1 ) )\n"
+		"end\n" );
+
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto mo = CreateModelObjective( LoadScenario( file ), file.parent_path() );
+	SearchPoint point( mo->info() );
+	auto model = mo->CreateModelFromParams( point );
+	model->AdvanceSimulationTo( 0.1 );
+
+	PropNode pn;
+	pn.set( "type", "ScriptMeasure" );
+	pn.set( "script_file", script_file );
+	auto measure = CreateMeasure( pn, point, *model, Location() );
+
+	// add_actuator_inputs adds values by index and skips nil
+	auto& acts = model->GetActuators();
+	XO_CHECK( acts.size() >= 3 );
+	const double inputs[] = { acts[0]->GetInput(), acts[1]->GetInput(), acts[2]->GetInput() };
+	XO_CHECK( measure->GetResult( *model ) == 0 );
+	XO_CHECK( acts[0]->GetInput() == inputs[0] + 0.25 );
+	XO_CHECK( acts[1]->GetInput() == inputs[1] );
+	XO_CHECK( acts[2]->GetInput() == inputs[2] + 0.5 );
+
+	// channel handles write to the acquired channels, channel_vec3 requires consecutive channels
+	Storage<> sto;
+	sto.AddChannel( "pos_y" );
+	auto& frame = sto.AddFrame( 0 );
+	measure->StoreData( frame, StoreDataFlags() );
+	XO_CHECK( frame["value"] == 2 );
+	XO_CHECK( frame["nil_value"] == 0 );
+	const auto vel_idx = sto.GetChannelIndex( "vel_x" );
+	XO_CHECK( sto.GetChannelIndex( "vel_y" ) == vel_idx + 1 && sto.GetChannelIndex( "vel_z" ) == vel_idx + 2 );
+	XO_CHECK( frame["vel_x"] == 1 && frame["vel_y"] == 2 && frame["vel_z"] == 3 );
+	XO_CHECK( frame["vec3_error"] == 1 );
+	XO_CHECK( frame["handle_error"] == 1 );
+#endif
+}
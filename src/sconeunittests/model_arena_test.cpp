@@ -0,0 +1,117 @@
+/*
+** model_arena_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/sconelib_config.h"
+#include "scone/core/ModelArena.h"
+#include "scone/core/system_tools.h"
+#include "scone/optimization/opt_tools.h"
+#include "test_tools.h"
+
+#include "xo/system/test_case.h"
+
+#include <cstdint>
+#include <memory>
+
+using namespace scone;
+
+namespace
+{
+	struct ArenaObject : public ArenaAllocated
+	{
+		ArenaObject( int& destroyed ) : destroyed_( destroyed ) {}
+		~ArenaObject() { ++destroyed_; }
+		int& destroyed_;
+		double values_[4] = {};
+	};
+
+	struct LargeArenaObject : public ArenaAllocated
+	{
+		char data_[2048] = {};
+	};
+
+	bool is_aligned( const void* p ) { return reinterpret_cast<std::uintptr_t>( p ) % alignof( std::max_align_t ) == 0; }
+	std::ptrdiff_t distance( const void* a, const void* b ) { return static_cast<const std::byte*>( b ) - static_cast<const std::byte*>( a ); }
+}
+
+// ArenaAllocated objects must use the active arena or the heap, and deleting arena objects must not release memory.
+XO_TEST_CASE( model_arena_test )
+{
+	int destroyed = 0;
+	ModelArena arena( 1024 );
+	XO_CHECK( arena.GetMemorySize() == 0 );
+
+	// without an active arena, objects are allocated on the heap
+	auto heap_obj = std::make_unique<ArenaObject>( destroyed );
+	XO_CHECK( is_aligned( heap_obj.get() ) );
+	XO_CHECK( arena.GetObjectCount() == 0 );
+	heap_obj.reset();
+	XO_CHECK( destroyed == 1 );
+
+	// objects are stored contiguously, each after an aligned header
+	std::unique_ptr<ArenaObject> a, b;
+	std::unique_ptr<LargeArenaObject> large;
+	{
+		ModelArenaScope scope( &arena );
+		XO_CHECK( ModelArena::GetActive() == &arena );
+		a = std::make_unique<ArenaObject>( destroyed );
+		b = std::make_unique<ArenaObject>( destroyed );
+		{
+			ModelArenaScope no_arena( nullptr );
+			heap_obj = std::make_unique<ArenaObject>( destroyed );
+		}
+		large = std::make_unique<LargeArenaObject>();
+	}
+	XO_CHECK( ModelArena::GetActive() == nullptr );
+	XO_CHECK( arena.GetObjectCount() == 3 );
+	XO_CHECK( is_aligned( a.get() ) && is_aligned( b.get() ) && is_aligned( large.get() ) );
+	const auto align = alignof( std::max_align_t );
+	const auto stride = ( sizeof( std::max_align_t ) + sizeof( ArenaObject ) + align - 1 ) / align * align;
+	XO_CHECK( distance( a.get(), b.get() ) == std::ptrdiff_t( stride ) );
+
+	// objects larger than the block size get their own block
+	const auto memory_size = arena.GetMemorySize();
+	XO_CHECK( memory_size >= 1024 + sizeof( LargeArenaObject ) );
+
+	// deleting calls the destructor, the memory is kept until the arena is destroyed
+	a.reset();
+	XO_CHECK( destroyed == 2 );
+	XO_CHECK( arena.GetObjectCount() == 2 );
+	XO_CHECK( arena.GetMemorySize() == memory_size );
+	b.reset();
+	large.reset();
+	heap_obj.reset();
+	XO_CHECK( destroyed == 4 );
+	XO_CHECK( arena.GetObjectCount() == 0 );
+}
+
+// Evaluations with use_model_arena must give the same fitness, and the model must destroy its components before its arena.
+XO_TEST_CASE( model_arena_evaluation_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto scenario_pn = LoadScenario( file );
+	set_child_props( scenario_pn, "SimulationObjective", "max_duration", 1.0 );
+	auto mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	set_child_props( scenario_pn, "SimulationObjective", "use_model_arena", true );
+	auto arena_mo = CreateModelObjective( scenario_pn, file.parent_path() );
+	SearchPoint point( mo->info() );
+
+	const auto reference = evaluate_point( *mo, point );
+	XO_CHECK( evaluate_point( *arena_mo, point ) == reference );
+	for ( auto fitness : evaluate_point_concurrently( *arena_mo, point, 4 ) )
+		XO_CHECK( fitness == reference );
+
+	const auto premature_count = ModelArena::GetPrematureDestructionCount();
+	{
+		SearchPoint model_point( point );
+		ModelUP model = arena_mo->CreateModelFromParams( model_point );
+		XO_CHECK( model->GetArena() && model->GetArena()->GetObjectCount() > 0 );
+	}
+	XO_CHECK( ModelArena::GetPrematureDestructionCount() == premature_count );
+#endif
+}
@@ -8,14 +8,26 @@
 
 #include "scone/core/Factories.h"
 #include "scone/core/math.h"
+#include "scone/optimization/AsyncFileReporter.h"
 #include "scone/optimization/CmaOptimizerSpot.h"
+#include "scone/optimization/EvaluationCache.h"
 #include "scone/optimization/Objective.h"
+#include "scone/optimization/ProcessEvaluator.h"
 #include "scone/optimization/opt_tools.h"
 
 #include "xo/filesystem/filesystem.h"
 #include "xo/filesystem/path.h"
 #include "xo/serialization/serialize.h"
 #include "xo/system/test_case.h"
+#include "xo/time/timer.h"
+#include "spot/file_reporter.h"
+
+#include <algorithm>
+#include <numeric>
+
+#ifndef _WIN32
+#	include <sys/stat.h>
+#endif
 
 using namespace scone;
 
@@ -30,3 +42,157 @@ XO_TEST_CASE( optimization_test )
 
 	XO_CHECK_MESSAGE( o->GetBestFitness() < 1000.0, to_str( o->GetBestFitness() ) );
 }
+
+XO_TEST_CASE( async_file_reporter_test )
+{
+	// AsyncFileReporter must produce the same files as spot::file_reporter
+	auto test_folder = scone::GetFolder( scone::SconeFolder::Root ) / "resources/unittestdata/optimization_test";
+	const PropNode pn = xo::load_file( test_folder / "schwefel_5.xml" );
+	OptimizerUP o = CreateOptimizer( pn, test_folder );
+	o->output_root = xo::temp_directory_path() / "SCONE/async_file_reporter_test";
+	auto& opt = dynamic_cast<CmaOptimizer&>( *o );
+
+	auto spot_folder = xo::create_unique_directory( o->output_root / "spot_file_reporter" );
+	auto fr = std::make_unique< spot::file_reporter >( spot_folder, o->min_improvement_for_file_output, o->max_generations_without_file_output );
+	fr->output_fitness_history_ = true;
+	fr->output_par_history_ = true;
+	fr->output_individual_search_points = false;
+	opt.add_reporter( std::move( fr ) );
+
+	auto async_folder = xo::create_unique_directory( o->output_root / "async_file_reporter" );
+	auto afr = std::make_unique< AsyncFileReporter >( async_folder, o->min_improvement_for_file_output, o->max_generations_without_file_output );
+	afr->output_fitness_history_ = true;
+	afr->output_par_history_ = true;
+	opt.add_reporter( std::move( afr ) );
+
+	o->Run();
+
+	// history files must be identical
+	for ( auto name : { "history.txt", "history_par.txt" } ) {
+		XO_CHECK_MESSAGE( xo::file_exists( async_folder / name ), name );
+		XO_CHECK_MESSAGE( xo::load_string( spot_folder / name ) == xo::load_string( async_folder / name ), name );
+	}
+
+	// pending .par files can be replaced by newer ones, but all written files and the last file must be identical
+	auto spot_files = xo::find_files( spot_folder, "*.par" );
+	auto async_files = xo::find_files( async_folder, "*.par" );
+	XO_CHECK( !async_files.empty() && async_files.size() <= spot_files.size() );
+	for ( const auto& f : async_files ) {
+		auto spot_file = spot_folder / f.filename();
+		XO_CHECK_MESSAGE( xo::file_exists( spot_file ), spot_file.str() );
+		XO_CHECK_MESSAGE( xo::load_string( f ) == xo::load_string( spot_file ), f.filename().str() );
+	}
+	auto by_name = []( const path& a, const path& b ) { return a.filename().str() < b.filename().str(); };
+	if ( !spot_files.empty() && !async_files.empty() )
+		XO_CHECK( std::max_element( spot_files.begin(), spot_files.end(), by_name )->filename() ==
+			std::max_element( async_files.begin(), async_files.end(), by_name )->filename() );
+}
+
+#ifndef _WIN32
+namespace
+{
+	// write a worker script that implements the ProcessEvaluator protocol, with the sum of the parameters as fitness
+	path write_sum_worker( const path& folder, size_t dim ) {
+		auto file = folder / xo::stringf( "sum_worker_%zu.sh", dim );
+		xo::save_string( file,
+			"#!/bin/sh\n"
+			"echo \"log output is ignored\"\n"
+			"echo \"@ready " + to_str( dim ) + "\"\n"
+			"while read -r msg id n values; do\n"
+			"	case \"$msg\" in\n"
+			"		@eval) echo \"@result $id $(echo \"$values\" | awk '{ s = 0; for ( i = 1; i <= NF; i++ ) s += $i; printf \"%.17g\", s }')\";;\n"
+			"		@quit) exit 0;;\n"
+			"	esac\n"
+			"done\n" );
+		::chmod( file.str().c_str(), 0755 );
+		return file;
+	}
+
+	// write a worker script that exits before reporting @ready
+	path write_failing_worker( const path& folder ) {
+		auto file = folder / "failing_worker.sh";
+		xo::save_string( file,
+			"#!/bin/sh\n"
+			"echo \"failing worker\" >&2\n"
+			"exit 1\n" );
+		::chmod( file.str().c_str(), 0755 );
+		return file;
+	}
+}
+#endif
+
+XO_TEST_CASE( process_evaluator_test )
+{
+#ifndef _WIN32
+	// ProcessEvaluator with local worker processes that compute the sum of all parameters
+	auto test_folder = scone::GetFolder( scone::SconeFolder::Root ) / "resources/unittestdata/optimization_test";
+	const PropNode pn = xo::load_file( test_folder / "schwefel_5.xml" );
+	OptimizerUP o = CreateOptimizer( pn, test_folder );
+	o->output_root = xo::temp_directory_path() / "SCONE/process_evaluator_test";
+	o->PrepareOutputFolder(); // creates config.scone, which is passed to the workers
+	const auto& obj = o->GetObjective();
+	const auto dim = obj.info().dim();
+
+	spot::search_point_vec points;
+	for ( size_t i = 0; i < 20; ++i ) {
+		std::vector<ParValue> values( dim );
+		std::iota( values.begin(), values.end(), 0.25 * i );
+		points.emplace_back( obj.info(), values );
+	}
+
+	ProcessEvaluatorSettings pes;
+	pes.worker_count = 3;
+	pes.task_timeout = 10;
+	pes.worker_command = write_sum_worker( o->GetOutputFolder(), dim );
+	ProcessEvaluator pe( pes );
+	for ( int repeat = 0; repeat < 2; ++repeat ) { // second batch reuses the workers
+		auto results = pe.evaluate( obj, points, xo::stop_token(), spot::priority_t() );
+		XO_CHECK( results.size() == points.size() );
+		for ( size_t i = 0; i < points.size(); ++i ) {
+			const auto& v = points[ i ].values();
+			XO_CHECK_MESSAGE( results[ i ] && results[ i ].value() == std::accumulate( v.begin(), v.end(), 0.0 ), to_str( i ) );
+		}
+	}
+
+	// workers must report the number of parameters of the objective
+	pes.worker_command = write_sum_worker( o->GetOutputFolder(), dim + 1 );
+	ProcessEvaluator invalid_pe( pes );
+	bool invalid_worker_error = false;
+	try { invalid_pe.evaluate( obj, points, xo::stop_token(), spot::priority_t() ); }
+	catch ( std::exception& ) { invalid_worker_error = true; }
+	XO_CHECK( invalid_worker_error );
+
+	// workers that exit before @ready are restarted with a delay, until max_retries
+	pes.worker_command = write_failing_worker( o->GetOutputFolder() );
+	pes.max_retries = 2;
+	ProcessEvaluator failing_pe( pes );
+	bool failing_worker_error = false;
+	xo::timer failing_timer;
+	try { failing_pe.evaluate( obj, points, xo::stop_token(), spot::priority_t() ); }
+	catch ( std::exception& ) { failing_worker_error = true; }
+	XO_CHECK( failing_worker_error );
+	XO_CHECK( failing_timer().secondsd() < pes.task_timeout );
+#endif
+}
+
+// Entries stored by different caches of the same file must all be written, and read back on reload.
+XO_TEST_CASE( evaluation_cache_test )
+{
+	auto folder = xo::create_unique_directory( xo::temp_directory_path() / "SCONE/evaluation_cache_test" );
+	auto file = folder / "evaluation_cache.txt";
+	const EvaluationCache::key_t entry_count = 1000;
+	{
+		auto cache = EvaluationCache::GetCache( file );
+		XO_CHECK( cache == EvaluationCache::GetCache( file ) );
+		for ( EvaluationCache::key_t key = 0; key < entry_count; ++key )
+			cache->Store( key, 0.5 * key );
+		cache->Flush();
+		XO_CHECK( cache->Find( entry_count - 1 ) == 0.5 * ( entry_count - 1 ) );
+	} // the cache is destroyed with its last user
+
+	auto cache = EvaluationCache::GetCache( file );
+	XO_CHECK( cache->size() == entry_count );
+	for ( EvaluationCache::key_t key = 0; key < entry_count; ++key )
+		XO_CHECK( cache->Find( key ) == 0.5 * key );
+	XO_CHECK( !cache->Find( entry_count ) );
+}
@@ -0,0 +1,80 @@
+/*
+** profiler_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/sconelib_config.h"
+#include "scone/core/Log.h"
+#include "scone/core/Profiler.h"
+#include "scone/core/system_tools.h"
+#include "scone/optimization/opt_tools.h"
+#include "test_tools.h"
+
+#include "xo/system/test_case.h"
+#include "xo/time/timer.h"
+
+#include <thread>
+
+using namespace scone;
+
+// Threads that exit must hand their buffer to the next thread, without losing recorded events.
+XO_TEST_CASE( profiler_thread_buffer_test )
+{
+	Profiler prof;
+	prof.Activate();
+	const ProfileScope scope( prof, "profiler_thread_buffer_test" );
+	const size_t thread_count = 16, events_per_thread = 100;
+	for ( size_t i = 0; i < thread_count; ++i )
+		std::thread( [&]() { for ( size_t e = 0; e < events_per_thread; ++e ) ScopedProfile sp( scope ); } ).join();
+	XO_CHECK( prof.GetThreadBufferCount() == 1 );
+	XO_CHECK( prof.GetEventCount() == thread_count * events_per_thread );
+
+	// threads that run at the same time need their own buffer
+	std::thread t1( [&]() { ScopedProfile sp( scope ); std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) ); } );
+	std::thread t2( [&]() { ScopedProfile sp( scope ); std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) ); } );
+	t1.join();
+	t2.join();
+	XO_CHECK( prof.GetThreadBufferCount() == 2 );
+	XO_CHECK( prof.GetEventCount() == thread_count * events_per_thread + 2 );
+}
+
+// Scopes of an inactive profiler must not record events and should be cheap compared to a simulation step.
+// Timings are only logged, because they depend on the machine and on other tests running at the same time.
+XO_TEST_CASE( profiler_overhead_test )
+{
+	Profiler prof;
+	const ProfileScope scope( prof, "profiler_overhead_test" );
+	const size_t scope_count = 1000000;
+	volatile size_t sink = 0;
+	auto time_scopes = [&]() {
+		xo::timer t;
+		for ( size_t i = 0; i < scope_count; ++i ) {
+			ScopedProfile sp( scope );
+			sink = sink + i;
+		}
+		return t().secondsd() / scope_count;
+	};
+
+	const auto inactive_scope_time = time_scopes();
+	XO_CHECK( prof.GetEventCount() == 0 );
+	prof.Activate();
+	const auto active_scope_time = time_scopes();
+	prof.Suspend();
+	XO_CHECK( prof.GetEventCount() == scope_count );
+	log::info( "Profiler scope: ", 1e9 * inactive_scope_time, " ns inactive; ", 1e9 * active_scope_time, " ns active" );
+
+#if SCONE_OPENSIM_3_ENABLED
+	// the global profiler is left untouched, other tests may use it concurrently
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto mo = CreateModelObjective( LoadScenario( file ), file.parent_path() );
+	SearchPoint point( mo->info() );
+	auto model = mo->CreateModelFromParams( point );
+	xo::timer step_timer;
+	model->AdvanceSimulationTo( 0.5 );
+	const auto step_time = step_timer().secondsd() / model->GetIntegrationStep();
+	log::info( "Step time: ", 1e6 * step_time, " us; inactive scopes per step for 1% overhead: ", 0.01 * step_time / inactive_scope_time );
+#endif
+}
@@ -0,0 +1,109 @@
+/*
+** ray_caster_test.cpp
+**
+** Copyright (C) Thomas Geijtenbeek and contributors. All rights reserved.
+**
+** This file is part of SCONE. For more information, see http://scone.software.
+*/
+
+#include "scone/sconelib_config.h"
+#include "scone/core/system_tools.h"
+#include "scone/model/Body.h"
+#include "scone/model/RayCaster.h"
+#include "scone/model/Sensors.h"
+#include "scone/optimization/opt_tools.h"
+#include "test_tools.h"
+
+#include "xo/system/test_case.h"
+
+#include <cmath>
+
+using namespace scone;
+
+namespace
+{
+	bool is_near( Real a, Real b ) { return std::abs( a - b ) < 1e-9; }
+	bool is_no_hit( Real t ) { return std::isinf( t ); }
+}
+
+XO_TEST_CASE( ray_sphere_test )
+{
+	XO_CHECK( is_near( IntersectRaySphere( Vec3( 0, 5, 0 ), Vec3( 0, -1, 0 ), 1 ), 4 ) );
+	XO_CHECK( is_near( IntersectRaySphere( Vec3( 0, 0, 0 ), Vec3( 1, 0, 0 ), 1 ), 0 ) ); // inside
+	XO_CHECK( is_no_hit( IntersectRaySphere( Vec3( 0, 5, 0 ), Vec3( 0, 1, 0 ), 1 ) ) ); // pointing away
+	XO_CHECK( is_no_hit( IntersectRaySphere( Vec3( 2, 5, 0 ), Vec3( 0, -1, 0 ), 1 ) ) ); // miss
+	XO_CHECK( is_near( IntersectRaySphere( Vec3( 1, 5, 0 ), Vec3( 0, -1, 0 ), 1 ), 5 ) ); // tangent
+}
+
+XO_TEST_CASE( ray_box_test )
+{
+	const Vec3 h( 1, 2, 3 );
+	XO_CHECK( is_near( IntersectRayBox( Vec3( 5, 0, 0 ), Vec3( -1, 0, 0 ), h ), 4 ) );
+	XO_CHECK( is_near( IntersectRayBox( Vec3( 0, -5, 0 ), Vec3( 0, 1, 0 ), h ), 3 ) );
+	XO_CHECK( is_near( IntersectRayBox( Vec3( 0, 0, 0 ), Vec3( 0, 0, 1 ), h ), 0 ) ); // inside
+	XO_CHECK( is_no_hit( IntersectRayBox( Vec3( 5, 0, 0 ), Vec3( 1, 0, 0 ), h ) ) ); // pointing away
+	XO_CHECK( is_no_hit( IntersectRayBox( Vec3( 5, 3, 0 ), Vec3( -1, 0, 0 ), h ) ) ); // parallel miss
+	const auto d = xo::normalized( Vec3( -1, -1, 0 ) );
+	XO_CHECK( is_near( IntersectRayBox( Vec3( 3, 3, 0 ), d, h ), std::sqrt( 2.0 ) * 2 ) ); // diagonal, enters at x = 1
+}
+
+XO_TEST_CASE( ray_plane_test )
+{
+	const Vec3 n( 0, 1, 0 );
+	XO_CHECK( is_near( IntersectRayPlane( Vec3( 0, 2, 0 ), Vec3( 0, -1, 0 ), n ), 2 ) );
+	XO_CHECK( is_near( IntersectRayPlane( Vec3( 0, -1, 0 ), Vec3( 0, 1, 0 ), n ), 0 ) ); // behind plane
+	XO_CHECK( is_no_hit( IntersectRayPlane( Vec3( 0, 2, 0 ), Vec3( 1, 0, 0 ), n ) ) ); // parallel
+	XO_CHECK( is_no_hit( IntersectRayPlane( Vec3( 0, 2, 0 ), Vec3( 0, 1, 0 ), n ) ) ); // pointing away
+	const auto d = xo::normalized( Vec3( 1, -1, 0 ) );
+	XO_CHECK( is_near( IntersectRayPlane( Vec3( 0, 2, 0 ), d, n ), std::sqrt( 2.0 ) * 2 ) );
+}
+
+XO_TEST_CASE( ray_capsule_cylinder_test )
+{
+	XO_CHECK( is_near( IntersectRayCapsule( Vec3( 0, 5, 0 ), Vec3( 0, -1, 0 ), 0.5, 1 ), 3.5 ) ); // end cap
+	XO_CHECK( is_near( IntersectRayCapsule( Vec3( 5, 0, 0 ), Vec3( -1, 0, 0 ), 0.5, 1 ), 4.5 ) ); // side
+	XO_CHECK( is_near( IntersectRayCylinder( Vec3( 0, 5, 0 ), Vec3( 0, -1, 0 ), 0.5, 1 ), 4 ) ); // end cap
+	XO_CHECK( is_near( IntersectRayCylinder( Vec3( 5, 0, 0 ), Vec3( -1, 0, 0 ), 0.5, 1 ), 4.5 ) ); // side
+	XO_CHECK( is_no_hit( IntersectRayCylinder( Vec3( 5, 2, 0 ), Vec3( -1, 0, 0 ), 0.5, 1 ) ) ); // above
+}
+
+// Ray distance sensors must ignore their own body, be distinct per direction, and follow state changes at the same time.
+XO_TEST_CASE( body_ray_distance_sensor_test )
+{
+#if SCONE_OPENSIM_3_ENABLED
+	auto file = GetInstallFolder() / "scenarios/Tutorials3/Tutorial 4a - Gait - OpenSim.scone";
+	auto mo = CreateModelObjective( LoadScenario( file ), file.parent_path() );
+	SearchPoint point( mo->info() );
+	auto model = mo->CreateModelFromParams( point );
+	const auto& calcn = *FindByName( model->GetBodies(), "calcn_r" );
+
+	// raise the model without changing the time, which must update the distances
+	auto raise_model = [&]( Real height ) {
+		auto state = model->GetState();
+		const auto idx = state.FindIndex( "pelvis_ty" );
+		state[ idx ] += height;
+		model->SetState( state, model->GetTime() );
+	};
+
+	// the ray starts inside the heel contact sphere of calcn_r, which must be ignored
+	const Vec3 heel( 0.015, 0.015, -0.005 );
+	auto& down = model->AcquireSensor<BodyRayDistanceSensor>( calcn, heel, Vec3( 0, -1, 0 ), 10.0 );
+	auto& up = model->AcquireSensor<BodyRayDistanceSensor>( calcn, heel, Vec3( 0, 1, 0 ), 10.0 );
+	XO_CHECK( &down != &up );
+	XO_CHECK( down.GetName() != up.GetName() );
+	XO_CHECK( &model->AcquireSensor<BodyRayDistanceSensor>( calcn, heel, Vec3( 0, -1, 0 ), 10.0 ) == &down );
+	XO_CHECK( &model->AcquireSensor<BodyRayDistanceSensor>( calcn, heel + Vec3( 0.01, 0, 0 ), Vec3( 0, -1, 0 ), 10.0 ) != &down );
+	XO_CHECK( &model->AcquireSensor<BodyRayDistanceSensor>( calcn, heel, Vec3( 0, -1, 0 ), 5.0 ) != &down );
+	raise_model( 0.2 );
+	const auto d0 = down.GetValue();
+	XO_CHECK( d0 > 0 && d0 < 10.0 );
+	XO_CHECK( up.GetValue() == 10.0 );
+	raise_model( 0.1 );
+	XO_CHECK_MESSAGE( std::abs( down.GetValue() - d0 - 0.1 ) < 1e-6, stringf( "%g -> %g", d0, down.GetValue() ) );
+
+	bool invalid_direction_error = false;
+	try { model->AcquireSensor<BodyRayDistanceSensor>( calcn, heel, Vec3::zero(), 10.0 ); }
+	catch ( std::exception& ) { invalid_direction_error = true; }
+	XO_CHECK( invalid_direction_error );
+#endif
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "scone/core/PropNode.h"
+#include "scone/core/types.h"
+#include "scone/optimization/ModelObjective.h"
+#include "xo/system/test_case.h"
+
+#include <thread>
+#include <vector>
+
+namespace scone
+{
+	// set key = value in all children named child_name, at any depth
+	template< typename T > void set_child_props( PropNode& pn, const String& child_name, const String& key, const T& value ) {
+		for ( auto& [child_key, child_pn] : pn ) {
+			if ( child_key == child_name )
+				child_pn.set( key, value );
+			set_child_props( child_pn, child_name, key, value );
+		}
+	}
+
+	// evaluate a search point, throws if the evaluation fails
+	inline fitness_t evaluate_point( const Objective& obj, const SearchPoint& point ) {
+		auto r = obj.evaluate( point, xo::stop_token() );
+		SCONE_ERROR_IF( !r, "Evaluation failed: " + r.error().message() );
+		return r.value();
+	}
+
+	// evaluate a search point concurrently from thread_count threads
+	inline std::vector< fitness_t > evaluate_point_concurrently( const Objective& obj, const SearchPoint& point, size_t thread_count ) {
+		std::vector< fitness_t > results( thread_count, fitness_t( 0 ) );
+		std::vector< std::thread > threads;
+		for ( size_t i = 0; i < thread_count; ++i )
+			threads.emplace_back( [&, i]() { results[i] = evaluate_point( obj, point ); } );
+		for ( auto& t : threads )
+			t.join();
+		return results;
+	}
+}